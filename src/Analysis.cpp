@@ -31,6 +31,7 @@
 #include "Analysis.h"
 
 #include "general/Logger.h"
+#include "methods/CrossingIndex.h"
 #include "methods/Method_A.h"
 #include "methods/Method_B.h"
 #include "methods/Method_C.h"
@@ -62,10 +63,53 @@
 #include <direct.h>
 #endif
 
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#endif
+
 
 using boost::geometry::dsv;
 using namespace std;
 
+namespace
+{
+/**
+ * whether each area is the last one with its id, files which only depend on the id of the area
+ * are written by this one like they were when the areas were processed one after another
+ */
+vector<bool> IsLastWithId(const vector<MeasurementArea_B *> & areas)
+{
+    vector<bool> isLast(areas.size(), true);
+    for(size_t i = 0; i < areas.size(); i++) {
+        for(size_t j = i + 1; j < areas.size(); j++) {
+            if(areas[j]->_id == areas[i]->_id) {
+                isLast[i] = false;
+                break;
+            }
+        }
+    }
+    return isLast;
+}
+
+/// whether each pair of area and line is the last one with the ids of both, like IsLastWithId
+vector<bool>
+IsLastWithIds(const vector<MeasurementArea_B *> & areas, const vector<MeasurementArea_L *> & lines)
+{
+    vector<bool> isLast(areas.size(), true);
+    for(size_t i = 0; i < areas.size(); i++) {
+        for(size_t j = i + 1; j < areas.size(); j++) {
+            if(areas[j]->_id == areas[i]->_id && lines[j]->_id == lines[i]->_id) {
+                isLast[i] = false;
+                break;
+            }
+        }
+    }
+    return isLast;
+}
+} // namespace
+
 /************************************************
  // Konstruktoren
  ************************************************/
@@ -167,7 +211,8 @@ void Analysis::InitArgs(ArgumentParser * args)
             MeasurementArea_B * area = dynamic_cast<MeasurementArea_B *>(
                 args->GetMeasurementArea(args->_configDataD.areaIDs[i]));
             if(area->_poly.outer().empty()) {
-                area->_poly = _boundingBox;
+                area->_poly      = _boundingBox;
+                area->_predicate = AreaPredicate(area->_poly);
             }
             _areasForMethodD.push_back(area);
         }
@@ -320,11 +365,29 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
         return EXIT_FAILURE;
     }
 
+    if(_DoesUseMethodA || _DoesUseMethodC || _DoesUseMethodD) {
+        // the velocities are needed in every frame of all measurement areas
+        data.PrecomputeVelocities();
+    }
+
+    // the crossings of all measurement lines are searched in one pass over the trajectories
+    CrossingIndex crossings;
+    if(_DoesUseMethodA || _DoesUseMethodE || _DoesUseMethodF) {
+        std::vector<const MeasurementArea_L *> lines;
+        lines.insert(lines.end(), _areasForMethodA.begin(), _areasForMethodA.end());
+        lines.insert(lines.end(), _linesForMethodE.begin(), _linesForMethodE.end());
+        lines.insert(lines.end(), _linesForMethodF.begin(), _linesForMethodF.end());
+        crossings = CrossingIndex(lines, data.GetXCor(), data.GetYCor());
+    }
+
+    // an area for which a method fails does not stop the others, the failure is returned at the end
+    bool failed = false;
+
     //-----------------------------check whether there is pedestrian outside the whole
     // geometry--------------------------------------------
-    std::map<int, std::vector<int>> _peds_t = data.GetPedIDsByFrameNr();
+    const FrameIndex & _peds_t = data.GetPedIDsByFrameNr();
     for(int frameNr = 0; frameNr < data.GetNumFrames(); frameNr++) {
-        vector<int> ids         = _peds_t[frameNr];
+        IndexRange ids          = _peds_t[frameNr];
         vector<int> IdInFrame   = data.GetIdInFrame(frameNr, ids);
         vector<double> XInFrame = data.GetXInFrame(frameNr, ids);
         vector<double> YInFrame = data.GetYInFrame(frameNr, ids);
@@ -351,17 +414,19 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             LOG_ERROR("Method A selected with no measurement area!");
             exit(EXIT_FAILURE);
         }
-#pragma omp parallel for
+#pragma omp parallel for reduction(||: failed)
         for(int i = 0; i < int(_areasForMethodA.size()); i++) {
             Method_A method_A;
             method_A.SetMeasurementArea(_areasForMethodA[i]);
             method_A.SetTimeInterval(_deltaT[i]);
+            method_A.SetCrossingIndex(&crossings);
             bool result_A = method_A.Process(data, _scriptsLocation, _areasForMethodA[i]->_zPos);
             if(result_A) {
                 LOG_INFO(
                     "Success with Method A using measurement area id {}!\n",
                     _areasForMethodA[i]->_id);
             } else {
+                failed = true;
                 LOG_ERROR(
                     "Failed with Method A using measurement area id {}!\n",
                     _areasForMethodA[i]->_id);
@@ -376,7 +441,7 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             exit(EXIT_FAILURE);
         }
 
-#pragma omp parallel for
+#pragma omp parallel for reduction(||: failed)
         for(int i = 0; i < int(_areasForMethodB.size()); i++) {
             Method_B method_B;
             method_B.SetMeasurementArea(_areasForMethodB[i]);
@@ -386,6 +451,7 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
                     "Success with Method B using measurement area id {}!\n",
                     _areasForMethodB[i]->_id);
             } else {
+                failed = true;
                 LOG_ERROR(
                     "Failed with Method B using measurement area id {}!\n",
                     _areasForMethodB[i]->_id);
@@ -399,16 +465,20 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             LOG_ERROR("Method C selected with no measurement area!");
             exit(EXIT_FAILURE);
         }
-#pragma omp parallel for
+        // with fewer measurement areas than threads the frames of each area are processed in
+        // parallel instead, nested parallel regions would only get one thread
+        const bool parallelAreas = int(_areasForMethodC.size()) >= omp_get_max_threads();
+#pragma omp parallel for if(parallelAreas) reduction(||: failed)
         for(int i = 0; i < int(_areasForMethodC.size()); i++) {
             Method_C method_C;
             method_C.SetMeasurementArea(_areasForMethodC[i]);
-            bool result_C = method_C.Process(data, _areasForMethodC[i]->_zPos);
+            bool result_C = method_C.Process(data, _areasForMethodC[i]->_zPos, !parallelAreas);
             if(result_C) {
                 LOG_INFO(
                     "Success with Method C using measurement area id {}!\n",
                     _areasForMethodC[i]->_id);
             } else {
+                failed = true;
                 LOG_ERROR(
                     "Failed with Method C using measurement area id {}!\n",
                     _areasForMethodC[i]->_id);
@@ -423,23 +493,56 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             exit(EXIT_FAILURE);
         }
 
-#pragma omp parallel for
+        // measurement areas in the same room and at the same height share the Voronoi diagrams
+        std::vector<std::vector<int>> areaGroups;
         for(int i = 0; i < int(_areasForMethodD.size()); i++) {
-            Method_D method_D;
-            // TODO: setting and processing should be restructured. constructor?
-            method_D.SetGeometryPolygon(_geoPolyMethodD[_areasForMethodD[i]->_id]);
-            method_D.SetGeometryBoundaries(_lowVertexX, _lowVertexY, _highVertexX, _highVertexY);
-            method_D.SetMeasurementArea(_areasForMethodD[i]);
-            bool result_D;
-            result_D = method_D.Process(configData_D, i, data, _areasForMethodD[i]->_zPos);
-            if(result_D) {
-                LOG_INFO(
-                    "Success with Method D using measurement area id {}!\n",
-                    _areasForMethodD[i]->_id);
+            const MeasurementArea_B * area = _areasForMethodD[i];
+            auto group                     = std::find_if(
+                areaGroups.begin(), areaGroups.end(), [&](const std::vector<int> & indices) {
+                    const MeasurementArea_B * first = _areasForMethodD[indices.front()];
+                    return first->_zPos == area->_zPos &&
+                           boost::geometry::equals(
+                               _geoPolyMethodD.at(first->_id), _geoPolyMethodD.at(area->_id));
+                });
+            if(group == areaGroups.end()) {
+                areaGroups.push_back({i});
             } else {
-                LOG_ERROR(
-                    "Failed with Method D using measurement area id {}!\n",
-                    _areasForMethodD[i]->_id);
+                group->push_back(i);
+            }
+        }
+
+        // with fewer rooms than threads the frames of each room are processed in parallel instead
+        const bool parallelRooms = int(areaGroups.size()) >= omp_get_max_threads();
+#pragma omp parallel for if(parallelRooms) reduction(||: failed)
+        for(int g = 0; g < int(areaGroups.size()); g++) {
+            const std::vector<int> & indices = areaGroups[g];
+            std::vector<Method_D> methods(indices.size());
+            for(std::size_t k = 0; k < indices.size(); k++) {
+                MeasurementArea_B * area = _areasForMethodD[indices[k]];
+                // TODO: setting and processing should be restructured. constructor?
+                methods[k].SetGeometryPolygon(_geoPolyMethodD.at(area->_id));
+                methods[k].SetGeometryBoundaries(
+                    _lowVertexX, _lowVertexY, _highVertexX, _highVertexY);
+                methods[k].SetMeasurementArea(area);
+            }
+            std::vector<bool> results = Method_D::Process(
+                configData_D,
+                methods,
+                indices,
+                data,
+                _areasForMethodD[indices.front()]->_zPos,
+                !parallelRooms);
+            for(std::size_t k = 0; k < indices.size(); k++) {
+                if(results[k]) {
+                    LOG_INFO(
+                        "Success with Method D using measurement area id {}!\n",
+                        _areasForMethodD[indices[k]]->_id);
+                } else {
+                    failed = true;
+                    LOG_ERROR(
+                        "Failed with Method D using measurement area id {}!\n",
+                        _areasForMethodD[indices[k]]->_id);
+                }
             }
         }
     }
@@ -450,11 +553,21 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             LOG_ERROR("Method E selected with no measurement area!");
             exit(EXIT_FAILURE);
         }
+        // the density file of an area is the same for all of its lines
+        const vector<bool> writesDensity = IsLastWithId(_areasForMethodE);
+        // the other files are named by the area and the line, the last pair overwrites them
+        const vector<bool> isLast = IsLastWithIds(_areasForMethodE, _linesForMethodE);
+#pragma omp parallel for schedule(dynamic) reduction(||: failed)
         for(int i = 0; i < int(_areasForMethodE.size()); i++) {
+            if(!isLast[i]) {
+                continue;
+            }
             Method_E method_E;
             method_E.SetMeasurementArea(_areasForMethodE[i]);
             method_E.SetLine(_linesForMethodE[i]);
             method_E.SetTimeInterval(_deltaTMethodE[i]);
+            method_E.SetCrossingIndex(&crossings);
+            method_E.SetWriteDensity(writesDensity[i]);
             bool result_E = method_E.Process(data, _areasForMethodE[i]->_zPos);
             if(result_E) {
                 LOG_INFO(
@@ -463,6 +576,7 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
                     _areasForMethodE[i]->_id,
                     _linesForMethodE[i]->_id);
             } else {
+                failed = true;
                 LOG_ERROR(
                     "Failed with Method E using measurement area id {} and "
                     "line id {}!\n",
@@ -478,11 +592,21 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             LOG_ERROR("Method F selected with no measurement area!");
             exit(EXIT_FAILURE);
         }
+        // the velocity file of an area is shared by all of its lines
+        const vector<bool> writesVelocity = IsLastWithId(_areasForMethodF);
+        // the other files are named by the area and the line, the last pair overwrites them
+        const vector<bool> isLast = IsLastWithIds(_areasForMethodF, _linesForMethodF);
+#pragma omp parallel for schedule(dynamic) reduction(||: failed)
         for(int i = 0; i < int(_areasForMethodF.size()); i++) {
+            if(!isLast[i]) {
+                continue;
+            }
             Method_F method_F;
             method_F.SetMeasurementArea(_areasForMethodF[i]);
             method_F.SetLine(_linesForMethodF[i]);
             method_F.SetTimeInterval(_deltaTMethodF[i]);
+            method_F.SetCrossingIndex(&crossings);
+            method_F.SetWriteVelocity(writesVelocity[i]);
             bool result_F = method_F.Process(data, _areasForMethodF[i]->_zPos);
             if(result_F) {
                 LOG_INFO(
@@ -491,6 +615,7 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
                     _areasForMethodF[i]->_id,
                     _linesForMethodF[i]->_id);
             } else {
+                failed = true;
                 LOG_ERROR(
                     "Failed with Method F using measurement area id {} and "
                     "line id {}!\n",
@@ -506,7 +631,13 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             LOG_ERROR("Method G selected with no measurement area!");
             exit(EXIT_FAILURE);
         }
+        // all files of an area are overwritten by its last occurrence
+        const vector<bool> isLast = IsLastWithId(_areasForMethodG);
+#pragma omp parallel for schedule(dynamic) reduction(||: failed)
         for(int i = 0; i < int(_areasForMethodG.size()); i++) {
+            if(!isLast[i]) {
+                continue;
+            }
             Method_G method_G;
             method_G.SetMeasurementArea(_areasForMethodG[i]);
             method_G.SetTimeInterval(_deltaTMethodG[i]);
@@ -519,6 +650,7 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
                     "Success with Method G using measurement area id {}!\n",
                     _areasForMethodG[i]->_id);
             } else {
+                failed = true;
                 LOG_ERROR(
                     "Failed with Method G using measurement area id {}!\n",
                     _areasForMethodG[i]->_id);
@@ -532,7 +664,13 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
             LOG_ERROR("Method H selected with no measurement area!");
             exit(EXIT_FAILURE);
         }
+        // all files of an area are overwritten by its last occurrence
+        const vector<bool> isLast = IsLastWithId(_areasForMethodH);
+#pragma omp parallel for schedule(dynamic) reduction(||: failed)
         for(int i = 0; i < int(_areasForMethodH.size()); i++) {
+            if(!isLast[i]) {
+                continue;
+            }
             Method_H method_H;
             method_H.SetMeasurementArea(_areasForMethodH[i]);
             method_H.SetTimeInterval(_deltaTMethodH[i]);
@@ -542,6 +680,7 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
                     "Success with Method H using measurement area id {}!\n",
                     _areasForMethodH[i]->_id);
             } else {
+                failed = true;
                 LOG_ERROR(
                     "Failed with Method H using measurement area id {}!\n",
                     _areasForMethodH[i]->_id);
@@ -549,7 +688,7 @@ int Analysis::RunAnalysis(const fs::path & filename, const fs::path & path)
         }
     }
 
-    return 0;
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
 FILE * Analysis::CreateFile(const string & filename)
@@ -557,7 +696,9 @@ FILE * Analysis::CreateFile(const string & filename)
     // create the directory for the file
     fs::path filepath = fs::path(filename.c_str()).parent_path();
     if(fs::is_directory(filepath) == false) {
-        if(fs::create_directories(filepath) == false && fs::is_directory(filepath) == false) {
+        // no exception, the files are also created by the threads of the frame loop of Method D
+        std::error_code ec;
+        if(fs::create_directories(filepath, ec) == false && fs::is_directory(filepath) == false) {
             LOG_ERROR("cannot create the directory <{}>", filepath.string());
             return NULL;
         }
@@ -66,7 +66,7 @@ public:
      * Run the analysis for different files.
      * @param file
      * @param path
-     * @return
+     * @return EXIT_FAILURE if the file cannot be read or a method fails for a measurement area
      */
     int RunAnalysis(const fs::path & file, const fs::path & path);
 
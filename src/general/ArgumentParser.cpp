@@ -370,7 +370,8 @@ bool ArgumentParser::ParseInifile(const fs::path & inifile)
                     num_verteces);
 
             correct(poly); // in the case the Polygone is not closed
-            areaB->_poly = poly;
+            areaB->_poly      = poly;
+            areaB->_predicate = AreaPredicate(areaB->_poly);
 
             TiXmlElement * xLength =
                 xMeasurementArea_B->FirstChildElement("length_in_movement_direction");
@@ -451,6 +452,8 @@ bool ArgumentParser::ParseInifile(const fs::path & inifile)
                 exit(EXIT_FAILURE);
             }
 
+            areaL->_crossing = LineCrossing(
+                areaL->_lineStartX, areaL->_lineStartY, areaL->_lineEndX, areaL->_lineEndY);
             _measurementAreasByIDs[areaL->_id] = areaL;
             LOG_INFO(
                 "Measurement line starts from  <{:.3f}, {:.3f}> to <{:.3f}, {:.3f}>",
@@ -1051,6 +1054,35 @@ std::optional<ConfigData_D> ArgumentParser::ParseDIJParams(TiXmlElement * xMetho
             configData.gridSizeX * CMtoM,
             configData.gridSizeY * CMtoM);
 
+        // average the profiles over windows of frames
+        if(xProfile->Attribute("interval")) {
+            int interval = xmltoi(xProfile->Attribute("interval"));
+            if(interval > 0) {
+                configData.profileInterval = interval;
+                configData.profilePerFrame = false;
+                LOG_INFO("The profiles are averaged over intervals of <{}> frames", interval);
+                if(xProfile->Attribute("variance") &&
+                   string(xProfile->Attribute("variance")) == "true") {
+                    configData.profileVariance = true;
+                    LOG_INFO("The variance of the profiles in each interval will be output");
+                }
+            } else {
+                LOG_WARNING(
+                    "The interval of the profiles has to be a positive number of frames, the "
+                    "profiles are not averaged");
+            }
+        }
+        if(xProfile->Attribute("per_frame")) {
+            configData.profilePerFrame = string(xProfile->Attribute("per_frame")) == "true";
+        }
+        if(configData.profilePerFrame) {
+            LOG_INFO("The profiles of each frame will be output");
+        } else if(configData.profileInterval <= 0) {
+            LOG_WARNING(
+                "The profiles are neither output per frame nor averaged over an interval, no "
+                "profiles will be output");
+        }
+
         // read in start and stop frame
         if(xProfile->Attribute("start_frame") &&
            string(xProfile->Attribute("start_frame")) != "None") {
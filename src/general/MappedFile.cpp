@@ -0,0 +1,96 @@
+#include "MappedFile.h"
+
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path & path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileW(
+        path.wstring().c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if(file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER size;
+        if(GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if(mapping != nullptr) {
+                void * view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if(view != nullptr) {
+                    _mapping       = view;
+                    _mappingHandle = mapping;
+                    _data          = static_cast<const char *>(view);
+                    _size          = static_cast<std::size_t>(size.QuadPart);
+                    _isOpen        = true;
+                } else {
+                    CloseHandle(mapping);
+                }
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd >= 0) {
+        struct stat st;
+        if(::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void * view = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(view != MAP_FAILED) {
+                ::madvise(view, st.st_size, MADV_SEQUENTIAL);
+                _mapping = view;
+                _data    = static_cast<const char *>(view);
+                _size    = static_cast<std::size_t>(st.st_size);
+                _isOpen  = true;
+            }
+        }
+        ::close(fd);
+    }
+#endif
+    if(_isOpen) {
+        return;
+    }
+
+    // mapping is not possible, read the whole file instead
+    std::ifstream in(path, std::ios::binary);
+    if(!in.is_open()) {
+        return;
+    }
+    _buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    _data   = _buffer.data();
+    _size   = _buffer.size();
+    _isOpen = true;
+}
+
+MappedFile::~MappedFile()
+{
+    Unmap();
+}
+
+void MappedFile::Unmap()
+{
+    if(_mapping == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(_mapping);
+    CloseHandle(_mappingHandle);
+    _mappingHandle = nullptr;
+#else
+    ::munmap(_mapping, _size);
+#endif
+    _mapping = nullptr;
+}
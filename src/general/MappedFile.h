@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+/**
+ * Read-only view of the complete content of a file.
+ *
+ * The file is memory mapped where the platform supports it. If the file can not be mapped (e.g.
+ * it is empty or a pipe) its content is read into memory instead, so callers only have to deal
+ * with a contiguous character range.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path & path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    bool IsOpen() const { return _isOpen; }
+    const char * Data() const { return _data; }
+    std::size_t Size() const { return _size; }
+    std::string_view View() const { return {_data, _size}; }
+
+private:
+    void Unmap();
+
+    bool _isOpen       = false;
+    const char * _data = nullptr;
+    std::size_t _size  = 0;
+    void * _mapping    = nullptr; // start of the mapped region, nullptr if _buffer is used
+    std::string _buffer;
+#ifdef _WIN32
+    void * _mappingHandle = nullptr;
+#endif
+};
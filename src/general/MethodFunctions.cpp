@@ -8,8 +8,6 @@ using std::ofstream;
 using std::string;
 using std::vector;
 
-typedef boost::geometry::model::segment<boost::geometry::model::d2::point_xy<double>> segment;
-
 std::ofstream GetFile(
     string whatOutput,
     string idCombination,
@@ -25,7 +23,8 @@ std::ofstream GetFile(
     if(fs::is_directory(filepath) == false) {
         if(fs::create_directories(filepath) == false && fs::is_directory(filepath) == false) {
             LOG_ERROR("cannot create the directory <{}>", filepath.string());
-            exit(EXIT_FAILURE);
+            // the callers report the file which cannot be opened
+            return {};
         }
         LOG_INFO("create the directory <{}>", filepath.string());
     }
@@ -33,111 +32,31 @@ std::ofstream GetFile(
     return file;
 }
 
-bool IsPassLine(
-    double Line_startX,
-    double Line_startY,
-    double Line_endX,
-    double Line_endY,
-    double pt1_X,
-    double pt1_Y,
-    double pt2_X,
-    double pt2_Y)
-{
-    point_2d Line_pt0(Line_startX, Line_startY);
-    point_2d Line_pt1(Line_endX, Line_endY);
-    segment edge0(Line_pt0, Line_pt1);
-
-    point_2d Traj_pt0(pt1_X, pt1_Y);
-    point_2d Traj_pt1(pt2_X, pt2_Y);
-    segment edge1(Traj_pt0, Traj_pt1);
-
-    return (intersects(edge0, edge1));
-}
-
 int GetNumberOnLine(
     int frame,
-    const vector<int> & ids,
-    double lineStartX,
-    double lineStartY,
-    double lineEndX,
-    double lineEndY,
-    const ub::matrix<double> & xCor,
-    const ub::matrix<double> & yCor)
+    IndexRange ids,
+    const LineCrossing & line,
+    TrajectoryView<double> xCor,
+    TrajectoryView<double> yCor)
 {
     // returns number of pedestrians that are on the line at this frame
     int frameOnLine = 0;
     for(auto const i : ids) {
-        point_2d lineP0(lineStartX, lineStartY);
-        point_2d lineP1(lineEndX, lineEndY);
-        segment line(lineP0, lineP1);
-        point_2d posPed(xCor(i, frame), yCor(i, frame));
-
-        if(boost::geometry::distance(posPed, line) < 0.1) {
-            // distance is lower than 0.0001 m -> "on line"
+        // distance is lower than 0.0001 m -> "on line"
+        if(line.IsOnLine(xCor(i, frame), yCor(i, frame))) {
             frameOnLine++;
         }
     }
     return frameOnLine;
 }
 
-vector<vector<int>> GetTinTout(
-    int numFrames,
-    const polygon_2d & polygon,
-    int numPeds,
-    std::map<int, std::vector<int>> peds_t,
-    ub::matrix<double> xCor,
-    ub::matrix<double> yCor)
-{
-    vector<bool> IsinMeasurezone(numPeds, false);
-    vector<int> tIn(numPeds, 0);
-    vector<int> tOut(numPeds, 0);
-
-    for(int frameNr = 0; frameNr < numFrames; frameNr++) {
-        vector<int> ids = peds_t[frameNr];
-        for(int ID : ids) {
-            int x = xCor(ID, frameNr);
-            int y = yCor(ID, frameNr);
-
-            // this is variant 4
-            if(covered_by(make<point_2d>(x, y), polygon) && !(IsinMeasurezone[ID])) {
-                tIn[ID]             = frameNr;
-                IsinMeasurezone[ID] = true;
-            } else if((!within(make<point_2d>(x, y), polygon)) && IsinMeasurezone[ID]) {
-                if(tIn[ID] == 0 && frameNr == 1) {
-                    if(!within(make<point_2d>(xCor(ID, 0), yCor(ID, 0)), polygon)) {
-                        // edge case -> if first frame in general is exactly on the upper boundary
-                        // of MA, this is not the entrance frame, but the exit frame
-                        tOut[ID]            = 0;
-                        IsinMeasurezone[ID] = false;
-                        continue;
-                    }
-                }
-                tOut[ID]            = frameNr;
-                IsinMeasurezone[ID] = false;
-            }
-        }
-    }
-
-    vector<vector<int>> output;
-    output.push_back(tIn);
-    output.push_back(tOut);
-    return output;
-}
-
 double GetExactDistance(
     int pedId,
     int firstFrame,
     int lastFrame,
-    ub::matrix<double> xCor,
-    ub::matrix<double> yCor)
+    const CumulativeDistance & distance)
 {
-    double totalDist = 0;
-    for(int i = (firstFrame + 1); i <= lastFrame; i += 1) {
-        double dxq = (xCor(pedId, i - 1) - xCor(pedId, i)) * (xCor(pedId, i - 1) - xCor(pedId, i));
-        double dyq = (yCor(pedId, i - 1) - yCor(pedId, i)) * (yCor(pedId, i - 1) - yCor(pedId, i));
-        totalDist += sqrt(dxq + dyq) * CMtoM;
-    }
-    return totalDist;
+    return distance.Between(pedId, firstFrame, lastFrame);
 }
 
 enum class EntryExit { EntryAndExit, NoEntryNorExit, OnlyExit, OnlyEntry, NotInArea };
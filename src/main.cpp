@@ -45,6 +45,7 @@ int main(int argc, char ** argv)
     // Parsing the arguments
     ArgumentParser * args                       = new ArgumentParser();
     std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    int status                                  = EXIT_SUCCESS;
 
     if(args->ParseArgs(argc, argv)) {
         // get the number of file to analyse
@@ -63,7 +64,9 @@ int main(int argc, char ** argv)
 
                 return EXIT_FAILURE;
             }
-            analysis.RunAnalysis(File, Path);
+            if(analysis.RunAnalysis(File, Path) != EXIT_SUCCESS) {
+                status = EXIT_FAILURE;
+            }
             LOG_INFO("**********************************************************************");
             LOG_INFO("End Analysis for the file: {}\n", File.string().c_str());
         }
@@ -78,5 +81,5 @@ int main(int argc, char ** argv)
     LOG_INFO("Time elapsed:\t {:.2f} [s]\n", duration);
 
     delete args;
-    return (EXIT_SUCCESS);
+    return status;
 }
@@ -0,0 +1,190 @@
+#include "AreaPredicate.h"
+
+#include "ConvexClipper.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+/// points per block of the batched tests
+constexpr std::size_t BlockSize = 256;
+
+/// four vertices connected by alternating horizontal and vertical edges
+bool IsRectangle(const std::vector<point_2d> & points)
+{
+    if(points.size() != 4) {
+        return false;
+    }
+    for(std::size_t i = 0; i < 4; i++) {
+        const point_2d & a    = points[i];
+        const point_2d & b    = points[(i + 1) % 4];
+        const point_2d & c    = points[(i + 2) % 4];
+        const bool horizontal = a.y() == b.y() && b.x() == c.x();
+        const bool vertical   = a.x() == b.x() && b.y() == c.y();
+        if(!horizontal && !vertical) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <bool IncludeBoundary>
+bool BoostContains(double x, double y, const polygon_2d & polygon)
+{
+    const point_2d point(x, y);
+    return IncludeBoundary ? boost::geometry::covered_by(point, polygon) :
+                             boost::geometry::within(point, polygon);
+}
+} // namespace
+
+AreaPredicate::AreaPredicate(const polygon_2d & polygon) : _polygon(polygon)
+{
+    std::vector<point_2d> points;
+    OpenRing(polygon, points);
+    if(!polygon.inners().empty() || points.size() < 3) {
+        return;
+    }
+
+    double maxAbs = 0;
+    for(const auto & point : points) {
+        maxAbs = std::max({maxAbs, std::abs(point.x()), std::abs(point.y())});
+    }
+    // far above the rounding errors of the distances of points near the polygon
+    _tolerance = 1e-9 * (1 + maxAbs);
+
+    if(IsRectangle(points)) {
+        boost::geometry::model::box<point_2d> envelope;
+        boost::geometry::envelope(polygon, envelope);
+        _minX  = envelope.min_corner().x();
+        _minY  = envelope.min_corner().y();
+        _maxX  = envelope.max_corner().x();
+        _maxY  = envelope.max_corner().y();
+        _shape = Shape::Rectangle;
+        return;
+    }
+
+    if(IsConvex(polygon)) {
+        // boost::geometry::area is positive for clockwise rings, their inside is right of the edges
+        const double orientation = boost::geometry::area(polygon) > 0 ? 1 : -1;
+        for(std::size_t i = 0; i < points.size(); i++) {
+            const point_2d & a = points[i];
+            const point_2d & b = points[(i + 1) % points.size()];
+            const double dx    = b.x() - a.x();
+            const double dy    = b.y() - a.y();
+            const double norm  = std::sqrt(dx * dx + dy * dy);
+            const double nx    = orientation * dy / norm;
+            const double ny    = -orientation * dx / norm;
+            _nx.push_back(nx);
+            _ny.push_back(ny);
+            _c.push_back(-(nx * a.x() + ny * a.y()));
+        }
+        _shape = Shape::Convex;
+    }
+}
+
+bool AreaPredicate::Within(double x, double y) const
+{
+    return Contains<false>(x, y);
+}
+
+bool AreaPredicate::CoveredBy(double x, double y) const
+{
+    return Contains<true>(x, y);
+}
+
+void AreaPredicate::Within(
+    const double * xs,
+    const double * ys,
+    std::size_t n,
+    std::uint8_t * mask) const
+{
+    Contains<false>(xs, ys, n, mask);
+}
+
+void AreaPredicate::CoveredBy(
+    const double * xs,
+    const double * ys,
+    std::size_t n,
+    std::uint8_t * mask) const
+{
+    Contains<true>(xs, ys, n, mask);
+}
+
+double AreaPredicate::Distance(double x, double y) const
+{
+    double distance = 0;
+    Distances(&x, &y, 1, &distance);
+    return distance;
+}
+
+void AreaPredicate::Distances(
+    const double * xs,
+    const double * ys,
+    std::size_t n,
+    double * distance) const
+{
+    if(_shape == Shape::Rectangle) {
+        for(std::size_t i = 0; i < n; i++) {
+            const double dx = std::min(xs[i] - _minX, _maxX - xs[i]);
+            const double dy = std::min(ys[i] - _minY, _maxY - ys[i]);
+            distance[i]     = std::min(dx, dy);
+        }
+        return;
+    }
+    std::fill(distance, distance + n, std::numeric_limits<double>::max());
+    for(std::size_t edge = 0; edge < _c.size(); edge++) {
+        const double nx = _nx[edge];
+        const double ny = _ny[edge];
+        const double c  = _c[edge];
+        for(std::size_t i = 0; i < n; i++) {
+            distance[i] = std::min(distance[i], nx * xs[i] + ny * ys[i] + c);
+        }
+    }
+}
+
+template <bool IncludeBoundary>
+bool AreaPredicate::Contains(double x, double y) const
+{
+    if(_shape != Shape::General) {
+        const double distance = Distance(x, y);
+        if(distance > _tolerance) {
+            return true;
+        }
+        if(distance < -_tolerance) {
+            return false;
+        }
+    }
+    return BoostContains<IncludeBoundary>(x, y, _polygon);
+}
+
+template <bool IncludeBoundary>
+void AreaPredicate::Contains(
+    const double * xs,
+    const double * ys,
+    std::size_t n,
+    std::uint8_t * mask) const
+{
+    if(_shape == Shape::General) {
+        for(std::size_t i = 0; i < n; i++) {
+            mask[i] = Contains<IncludeBoundary>(xs[i], ys[i]);
+        }
+        return;
+    }
+    double distance[BlockSize];
+    for(std::size_t begin = 0; begin < n; begin += BlockSize) {
+        const std::size_t size = std::min(BlockSize, n - begin);
+        Distances(xs + begin, ys + begin, size, distance);
+        for(std::size_t i = 0; i < size; i++) {
+            mask[begin + i] = distance[i] > _tolerance;
+        }
+        // points near the boundary are rare, they are left to boost
+        for(std::size_t i = 0; i < size; i++) {
+            if(std::abs(distance[i]) <= _tolerance) {
+                mask[begin + i] =
+                    BoostContains<IncludeBoundary>(xs[begin + i], ys[begin + i], _polygon);
+            }
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "../general/Macros.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Point in polygon tests of a measurement area with the results of boost::geometry::within and
+ * boost::geometry::covered_by.
+ *
+ * Rectangles and convex polygons are compiled into half-planes when the predicate is created.
+ * Points clearly inside or outside of the polygon are classified by their distance to the
+ * half-planes, the batched tests do this in loops the compiler can vectorize. Points closer to the
+ * boundary than the rounding errors of the distance, and all points of other polygons, are tested
+ * with boost.
+ */
+class AreaPredicate
+{
+public:
+    enum class Shape { Rectangle, Convex, General };
+
+    AreaPredicate() = default;
+    explicit AreaPredicate(const polygon_2d & polygon);
+
+    Shape GetShape() const { return _shape; }
+    const polygon_2d & GetPolygon() const { return _polygon; }
+
+    /// same as boost::geometry::within(point, polygon)
+    bool Within(double x, double y) const;
+    /// same as boost::geometry::covered_by(point, polygon)
+    bool CoveredBy(double x, double y) const;
+
+    /// mask[i] = Within(xs[i], ys[i]) for n points
+    void Within(const double * xs, const double * ys, std::size_t n, std::uint8_t * mask) const;
+    /// mask[i] = CoveredBy(xs[i], ys[i]) for n points
+    void CoveredBy(const double * xs, const double * ys, std::size_t n, std::uint8_t * mask) const;
+
+private:
+    /// signed distance of the point to the boundary, positive inside, not for General shapes
+    double Distance(double x, double y) const;
+    void Distances(const double * xs, const double * ys, std::size_t n, double * distance) const;
+
+    template <bool IncludeBoundary>
+    bool Contains(double x, double y) const;
+    template <bool IncludeBoundary>
+    void Contains(const double * xs, const double * ys, std::size_t n, std::uint8_t * mask) const;
+
+    polygon_2d _polygon;
+    Shape _shape      = Shape::General;
+    double _tolerance = 0;
+    // bounds of a rectangle
+    double _minX = 0;
+    double _minY = 0;
+    double _maxX = 0;
+    double _maxY = 0;
+    // half-planes nx * x + ny * y + c >= 0 of a convex polygon, (nx, ny) is the inner unit normal
+    std::vector<double> _nx;
+    std::vector<double> _ny;
+    std::vector<double> _c;
+};
@@ -41,6 +41,11 @@ struct ConfigData_D {
     bool getProfile = false;
     float gridSizeX = 0.1;
     float gridSizeY = 0.1;
+    // number of frames averaged in one profile file, 0 for no averaging
+    int profileInterval = 0;
+    bool profileVariance = false;
+    // write the profiles of each frame
+    bool profilePerFrame = true;
 
     // parameters for cutting voronoi cells
     bool cutByCircle = false;
@@ -0,0 +1,174 @@
+#include "ConvexClipper.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+/// > 0 if p is left of the line a->b, < 0 if it is right of it
+double Side(const point_2d & a, const point_2d & b, const point_2d & p)
+{
+    return (b.x() - a.x()) * (p.y() - a.y()) - (b.y() - a.y()) * (p.x() - a.x());
+}
+
+bool SamePoint(const point_2d & a, const point_2d & b)
+{
+    return a.x() == b.x() && a.y() == b.y();
+}
+
+void AddPoint(std::vector<point_2d> & points, const point_2d & point)
+{
+    if(points.empty() || !SamePoint(points.back(), point)) {
+        points.push_back(point);
+    }
+}
+
+/// area of an open ring, positive for clockwise rings like boost::geometry::area
+double SignedArea(const std::vector<point_2d> & points)
+{
+    double sum = 0;
+    for(std::size_t i = 0; i < points.size(); i++) {
+        const point_2d & a = points[i];
+        const point_2d & b = points[(i + 1) % points.size()];
+        sum += a.x() * b.y() - b.x() * a.y();
+    }
+    return -0.5 * sum;
+}
+
+/// all turns in the same direction and the x direction changes at most twice
+bool IsConvexRing(const std::vector<point_2d> & points)
+{
+    const std::size_t n = points.size();
+    if(n < 3) {
+        return false;
+    }
+    int orientation = 0;
+    int firstXSign  = 0;
+    int xSign       = 0;
+    int xFlips      = 0;
+    for(std::size_t i = 0; i < n; i++) {
+        const point_2d & a = points[i];
+        const point_2d & b = points[(i + 1) % n];
+        const double turn  = Side(a, b, points[(i + 2) % n]);
+        if(turn != 0) {
+            const int sign = turn > 0 ? 1 : -1;
+            if(orientation == 0) {
+                orientation = sign;
+            } else if(sign != orientation) {
+                return false;
+            }
+        }
+        const double dx = b.x() - a.x();
+        if(dx != 0) {
+            const int sign = dx > 0 ? 1 : -1;
+            if(firstXSign == 0) {
+                firstXSign = sign;
+            } else if(sign != xSign) {
+                xFlips++;
+            }
+            xSign = sign;
+        }
+    }
+    if(xSign != firstXSign) {
+        xFlips++;
+    }
+    return orientation != 0 && xFlips <= 2;
+}
+} // namespace
+
+/// outer ring of the polygon without closing point and repeated points
+void OpenRing(const polygon_2d & polygon, std::vector<point_2d> & points)
+{
+    points.clear();
+    for(const auto & point : polygon.outer()) {
+        AddPoint(points, point);
+    }
+    while(points.size() > 1 && SamePoint(points.front(), points.back())) {
+        points.pop_back();
+    }
+}
+
+bool IsConvex(const polygon_2d & polygon)
+{
+    if(!polygon.inners().empty()) {
+        return false;
+    }
+    std::vector<point_2d> points;
+    OpenRing(polygon, points);
+    return IsConvexRing(points);
+}
+
+ConvexClipper::ConvexClipper(const polygon_2d & clip) : _clip(clip)
+{
+    OpenRing(clip, _vertices);
+    _isConvex = clip.inners().empty() && IsConvexRing(_vertices);
+    if(_isConvex && SignedArea(_vertices) < 0) {
+        std::reverse(_vertices.begin(), _vertices.end());
+    }
+}
+
+void ConvexClipper::Intersection(const polygon_2d & subject, polygon_list & result) const
+{
+    result.clear();
+    if(_isConvex && subject.inners().empty()) {
+        thread_local std::vector<point_2d> points;
+        OpenRing(subject, points);
+        if(IsConvexRing(points)) {
+            polygon_2d clipped;
+            if(ClipConvex(points, clipped)) {
+                result.push_back(std::move(clipped));
+            }
+            return;
+        }
+    }
+    boost::geometry::intersection(_clip, subject, result);
+}
+
+bool ConvexClipper::ClipConvex(std::vector<point_2d> & points, polygon_2d & result) const
+{
+    thread_local std::vector<point_2d> input;
+    const double subjectArea = std::fabs(SignedArea(points));
+
+    // Sutherland-Hodgman: clip the ring at each edge of the clip polygon in turn
+    for(std::size_t i = 0; i < _vertices.size() && !points.empty(); i++) {
+        const point_2d & a = _vertices[i];
+        const point_2d & b = _vertices[(i + 1) % _vertices.size()];
+        input.swap(points);
+        points.clear();
+        point_2d previous   = input.back();
+        double previousSide = Side(a, b, previous);
+        for(const point_2d & current : input) {
+            // the inside of a clockwise polygon is right of its edges
+            const double side = Side(a, b, current);
+            if((side <= 0) != (previousSide <= 0)) {
+                const double t = previousSide / (previousSide - side);
+                AddPoint(
+                    points,
+                    point_2d(
+                        previous.x() + t * (current.x() - previous.x()),
+                        previous.y() + t * (current.y() - previous.y())));
+            }
+            if(side <= 0) {
+                AddPoint(points, current);
+            }
+            previous     = current;
+            previousSide = side;
+        }
+        while(points.size() > 1 && SamePoint(points.front(), points.back())) {
+            points.pop_back();
+        }
+    }
+
+    // polygons which only touch each other have no intersection
+    const double area = SignedArea(points);
+    if(points.size() < 3 || std::fabs(area) <= 1e-12 * subjectArea) {
+        return false;
+    }
+    if(area < 0) {
+        std::reverse(points.begin(), points.end());
+    }
+    auto & ring = result.outer();
+    ring.assign(points.begin(), points.end());
+    ring.push_back(points.front());
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../general/Macros.h"
+
+#include <vector>
+
+/// outer ring of the polygon without closing point and repeated points
+void OpenRing(const polygon_2d & polygon, std::vector<point_2d> & points);
+
+/// true if the polygon has no holes and its outer ring is convex
+bool IsConvex(const polygon_2d & polygon);
+
+/**
+ * Intersection of polygons with a fixed clip polygon, e.g. a measurement area or a grid cell.
+ *
+ * If both the clip polygon and the clipped polygon are convex (as Voronoi cells usually are) the
+ * intersection is calculated with the Sutherland-Hodgman algorithm, otherwise with
+ * boost::geometry::intersection. In both cases the result is stored like
+ * boost::geometry::intersection does: closed clockwise polygons, none if the polygons do not
+ * overlap.
+ */
+class ConvexClipper
+{
+public:
+    /// the clip polygon has to outlive the clipper
+    explicit ConvexClipper(const polygon_2d & clip);
+
+    bool IsConvex() const { return _isConvex; }
+
+    /// replaces the content of result by the intersection of subject and the clip polygon
+    void Intersection(const polygon_2d & subject, polygon_list & result) const;
+
+private:
+    /// clips the open ring points of a convex polygon, points is used as buffer
+    bool ClipConvex(std::vector<point_2d> & points, polygon_2d & result) const;
+
+    const polygon_2d & _clip;
+    bool _isConvex;
+    /// vertices of the clip polygon in clockwise order, without closing point
+    std::vector<point_2d> _vertices;
+};
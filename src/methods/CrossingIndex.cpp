@@ -0,0 +1,102 @@
+#include "CrossingIndex.h"
+
+#include <algorithm>
+
+CrossingIndex::CrossingIndex(
+    const std::vector<const MeasurementArea_L *> & measurementLines,
+    TrajectoryView<double> xCor,
+    TrajectoryView<double> yCor)
+{
+    // lines used by several methods are indexed once
+    std::vector<const MeasurementArea_L *> lines;
+    for(const MeasurementArea_L * line : measurementLines) {
+        if(_lineIndices.emplace(line->_id, lines.size()).second) {
+            lines.push_back(line);
+        }
+    }
+    const int numLines = lines.size();
+
+    // events of each pedestrian over all lines, in the order of the lines and frames
+    const int numPeds = xCor.NumPeds();
+    std::vector<std::vector<std::pair<int, CrossingEvent>>> pedEvents(numPeds);
+#pragma omp parallel for schedule(dynamic)
+    for(int ped = 0; ped < numPeds; ped++) {
+        const int firstFrame = xCor.FirstFrame(ped);
+        const int numFrames  = xCor.NumFrames(ped);
+        if(numFrames == 0) {
+            continue;
+        }
+        const double * x = xCor.Span(ped);
+        const double * y = yCor.Span(ped);
+        thread_local std::vector<std::int8_t> direction;
+        direction.resize(numFrames - 1);
+        for(int line = 0; line < numLines; line++) {
+            const LineCrossing & crossing = lines[line]->_crossing;
+            if(crossing.IsOnLine(x[0], y[0])) {
+                pedEvents[ped].push_back({line, {ped, firstFrame, double(firstFrame), 0}});
+            }
+            // step k goes from frame firstFrame + k to frame firstFrame + k + 1
+            crossing.Crossings(x, y, x + 1, y + 1, numFrames - 1, direction.data());
+            for(int k = 0; k + 1 < numFrames; k++) {
+                if(direction[k] != 0) {
+                    const double fraction = crossing.Fraction(x[k], y[k], x[k + 1], y[k + 1]);
+                    const int frame       = firstFrame + k + 1;
+                    pedEvents[ped].push_back(
+                        {line, {ped, frame, frame - 1 + fraction, direction[k]}});
+                }
+            }
+        }
+    }
+
+    std::vector<std::size_t> counts(numLines, 0);
+    for(const auto & events : pedEvents) {
+        for(const auto & [line, event] : events) {
+            counts[line]++;
+        }
+    }
+    _offsets.assign(numLines + 1, 0);
+    for(int line = 0; line < numLines; line++) {
+        _offsets[line + 1] = _offsets[line] + counts[line];
+    }
+    _events.resize(_offsets.back());
+    std::vector<std::size_t> position(_offsets.begin(), _offsets.end() - 1);
+    for(const auto & events : pedEvents) {
+        for(const auto & [line, event] : events) {
+            _events[position[line]++] = event;
+        }
+    }
+    // the events are ordered by pedestrian, the stable sort keeps this order within a frame
+    for(int line = 0; line < numLines; line++) {
+        std::stable_sort(
+            _events.begin() + _offsets[line],
+            _events.begin() + _offsets[line + 1],
+            [](const CrossingEvent & a, const CrossingEvent & b) { return a.frame < b.frame; });
+    }
+}
+
+ConstSpan<CrossingEvent> CrossingIndex::Events(int lineId) const
+{
+    auto line = _lineIndices.find(lineId);
+    if(line == _lineIndices.end()) {
+        return {};
+    }
+    return {_events.data() + _offsets[line->second], _events.data() + _offsets[line->second + 1]};
+}
+
+std::vector<int> CrossingIndex::PassingFrames(
+    int lineId,
+    int numPeds,
+    bool withStartOnLine,
+    const std::function<bool(int, int)> & isValid) const
+{
+    std::vector<int> passingFrames(numPeds, -1);
+    for(const CrossingEvent & event : Events(lineId)) {
+        if(passingFrames[event.ped] >= 0 || (event.direction == 0 && !withStartOnLine)) {
+            continue;
+        }
+        if(isValid(event.ped, event.frame)) {
+            passingFrames[event.ped] = event.frame;
+        }
+    }
+    return passingFrames;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "MeasurementArea.h"
+#include "TrajectoryStore.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+/// a pedestrian crossing a measurement line or standing on it in its first frame
+struct CrossingEvent {
+    int ped;
+    // frame at the end of the step over the line
+    int frame;
+    // frame of the crossing point, interpolated within the step from frame - 1 to frame
+    double subFrame;
+    // 1 or -1 as from LineCrossing::Crossing, 0 if the pedestrian is on the line in its first frame
+    std::int8_t direction;
+};
+
+/**
+ * Crossings of all pedestrians over a set of measurement lines.
+ *
+ * The trajectory of each pedestrian is swept once for all lines, the events of each line are
+ * sorted by frame and pedestrian. Methods filter the events themselves, e.g. by the height of the
+ * pedestrian.
+ */
+class CrossingIndex
+{
+public:
+    CrossingIndex() = default;
+    CrossingIndex(
+        const std::vector<const MeasurementArea_L *> & measurementLines,
+        TrajectoryView<double> xCor,
+        TrajectoryView<double> yCor);
+
+    /// events of the line with the id, empty for lines which are not indexed
+    ConstSpan<CrossingEvent> Events(int lineId) const;
+
+    /**
+     * frame in which each pedestrian passes the line first, -1 if it does not pass it
+     * @param lineId id of the line
+     * @param numPeds number of pedestrians
+     * @param withStartOnLine standing on the line in the first frame counts as passing it
+     * @param isValid whether an event of a pedestrian (first argument) in a frame (second
+     * argument) counts
+     */
+    std::vector<int> PassingFrames(
+        int lineId,
+        int numPeds,
+        bool withStartOnLine,
+        const std::function<bool(int, int)> & isValid) const;
+
+private:
+    std::map<int, int> _lineIndices; // line id -> position in _offsets
+    std::vector<std::size_t> _offsets;
+    std::vector<CrossingEvent> _events;
+};
@@ -0,0 +1,248 @@
+#include "EntryExitIndex.h"
+
+#include "PedData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace
+{
+/// upper limit of the cells of the grid per side
+constexpr int MaxCellsPerSide = 64;
+
+using box = boost::geometry::model::box<point_2d>;
+
+/// areas whose envelopes overlap the cells of a uniform grid over all envelopes
+class AreaGrid
+{
+public:
+    explicit AreaGrid(const std::vector<const AreaPredicate *> & areas)
+    {
+        if(areas.empty()) {
+            return;
+        }
+        for(const AreaPredicate * area : areas) {
+            _envelopes.push_back(boost::geometry::return_envelope<box>(area->GetPolygon()));
+        }
+        _bounds = _envelopes.front();
+        for(const box & envelope : _envelopes) {
+            boost::geometry::expand(_bounds, envelope);
+        }
+
+        _cellsPerSide = std::clamp(
+            static_cast<int>(std::ceil(std::sqrt(static_cast<double>(areas.size())))),
+            1,
+            MaxCellsPerSide);
+        _cellWidth  = Extent(_bounds.min_corner().x(), _bounds.max_corner().x());
+        _cellHeight = Extent(_bounds.min_corner().y(), _bounds.max_corner().y());
+        _cells.resize(_cellsPerSide * _cellsPerSide);
+        for(std::size_t area = 0; area < _envelopes.size(); area++) {
+            ForCells(_envelopes[area], [&](int cell) { _cells[cell].push_back(area); });
+        }
+    }
+
+    /// areas whose envelopes intersect the box, in ascending order
+    void Query(const box & bounds, std::vector<int> & areas) const
+    {
+        areas.clear();
+        if(_cells.empty() || boost::geometry::disjoint(bounds, _bounds)) {
+            return;
+        }
+        ForCells(bounds, [&](int cell) {
+            for(int area : _cells[cell]) {
+                if(!boost::geometry::disjoint(bounds, _envelopes[area])) {
+                    areas.push_back(area);
+                }
+            }
+        });
+        std::sort(areas.begin(), areas.end());
+        areas.erase(std::unique(areas.begin(), areas.end()), areas.end());
+    }
+
+private:
+    /// size of a cell for the extent from min to max
+    double Extent(double min, double max) const
+    {
+        return max > min ? (max - min) / _cellsPerSide : 1;
+    }
+
+    int Cell(double value, double min, double size) const
+    {
+        return std::clamp(static_cast<int>((value - min) / size), 0, _cellsPerSide - 1);
+    }
+
+    template <typename Function>
+    void ForCells(const box & bounds, Function function) const
+    {
+        const double minX = _bounds.min_corner().x();
+        const double minY = _bounds.min_corner().y();
+        const int column0 = Cell(bounds.min_corner().x(), minX, _cellWidth);
+        const int column1 = Cell(bounds.max_corner().x(), minX, _cellWidth);
+        const int row0    = Cell(bounds.min_corner().y(), minY, _cellHeight);
+        const int row1    = Cell(bounds.max_corner().y(), minY, _cellHeight);
+        for(int row = row0; row <= row1; row++) {
+            for(int column = column0; column <= column1; column++) {
+                function(row * _cellsPerSide + column);
+            }
+        }
+    }
+
+    std::vector<box> _envelopes;
+    box _bounds;
+    int _cellsPerSide  = 0;
+    double _cellWidth  = 1;
+    double _cellHeight = 1;
+    std::vector<std::vector<int>> _cells;
+};
+} // namespace
+
+EntryExitIndex::EntryExitIndex(
+    const std::vector<const AreaPredicate *> & areas,
+    EntryExitRule rule,
+    TrajectoryView<double> xCor,
+    TrajectoryView<double> yCor)
+{
+    const AreaGrid grid(areas);
+    const int numAreas = areas.size();
+    _numPeds           = xCor.NumPeds();
+    _endFrames.assign(_numPeds, 0);
+
+    // events of each pedestrian over all areas, in the order of the areas and frames
+    std::vector<std::vector<std::pair<int, EntryExitEvent>>> pedEvents(_numPeds);
+#pragma omp parallel for schedule(dynamic)
+    for(int ped = 0; ped < _numPeds; ped++) {
+        const int firstFrame = xCor.FirstFrame(ped);
+        const int numFrames  = xCor.NumFrames(ped);
+        _endFrames[ped]      = firstFrame + numFrames;
+        if(numFrames == 0) {
+            continue;
+        }
+        const double * x = xCor.Span(ped);
+        const double * y = yCor.Span(ped);
+
+        thread_local std::vector<double> xs;
+        thread_local std::vector<double> ys;
+        thread_local std::vector<std::uint8_t> coveredBy;
+        thread_local std::vector<std::uint8_t> within;
+        thread_local std::vector<int> candidates;
+        xs.resize(numFrames);
+        ys.resize(numFrames);
+        coveredBy.resize(numFrames);
+        within.resize(numFrames);
+        for(int k = 0; k < numFrames; k++) {
+            // the positions are truncated to integers
+            xs[k] = (int) x[k];
+            ys[k] = (int) y[k];
+        }
+        const auto [minX, maxX] = std::minmax_element(xs.begin(), xs.end());
+        const auto [minY, maxY] = std::minmax_element(ys.begin(), ys.end());
+        grid.Query(box(point_2d(*minX, *minY), point_2d(*maxX, *maxY)), candidates);
+
+        for(int area : candidates) {
+            const AreaPredicate & predicate = *areas[area];
+            predicate.Within(xs.data(), ys.data(), numFrames, within.data());
+            if(rule == EntryExitRule::CoveredByWithin) {
+                predicate.CoveredBy(xs.data(), ys.data(), numFrames, coveredBy.data());
+            } else {
+                coveredBy = within;
+            }
+
+            bool inside = false;
+            int tIn     = 0;
+            for(int k = 0; k < numFrames; k++) {
+                const int frame = firstFrame + k;
+                if(coveredBy[k] && !inside) {
+                    tIn    = frame;
+                    inside = true;
+                    pedEvents[ped].push_back({area, {ped, frame, true, xs[k], ys[k]}});
+                } else if(!within[k] && inside) {
+                    inside = false;
+                    // edge case -> if first frame in general is exactly on the upper boundary of
+                    // MA, this is not the entrance frame, but the exit frame (an entry in frame 0
+                    // is in the first frame of the pedestrian, x[0] is its exact position)
+                    if(rule == EntryExitRule::CoveredByWithin && tIn == 0 && frame == 1 &&
+                       !predicate.Within(x[0], y[0])) {
+                        pedEvents[ped].push_back({area, {ped, 0, false, x[0], y[0]}});
+                    } else {
+                        pedEvents[ped].push_back({area, {ped, frame, false, xs[k], ys[k]}});
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<std::size_t> counts(numAreas, 0);
+    for(const auto & events : pedEvents) {
+        for(const auto & [area, event] : events) {
+            counts[area]++;
+        }
+    }
+    _offsets.assign(numAreas + 1, 0);
+    for(int area = 0; area < numAreas; area++) {
+        _offsets[area + 1] = _offsets[area] + counts[area];
+    }
+    _events.resize(_offsets.back());
+    std::vector<std::size_t> position(_offsets.begin(), _offsets.end() - 1);
+    for(const auto & events : pedEvents) {
+        for(const auto & [area, event] : events) {
+            _events[position[area]++] = event;
+        }
+    }
+}
+
+ConstSpan<EntryExitEvent> EntryExitIndex::Events(int area) const
+{
+    return {_events.data() + _offsets[area], _events.data() + _offsets[area + 1]};
+}
+
+EntryExitTimes EntryExitIndex::GetTinTout(int area, int numFrames) const
+{
+    EntryExitTimes times;
+    times.tIn.assign(_numPeds, 0);
+    times.tOut.assign(_numPeds, 0);
+    times.entrancePoint.assign(_numPeds, boost::geometry::make<point_2d>(0, 0));
+    times.exitPoint.assign(_numPeds, boost::geometry::make<point_2d>(0, 0));
+    for(const EntryExitEvent & event : Events(area)) {
+        const int detectedFrame = (!event.entry && event.frame == 0) ? 1 : event.frame;
+        if(detectedFrame >= numFrames) {
+            continue;
+        }
+        // later entries and exits overwrite the earlier ones
+        if(event.entry) {
+            times.tIn[event.ped] = event.frame;
+            times.entrancePoint[event.ped].x(event.x * CMtoM);
+            times.entrancePoint[event.ped].y(event.y * CMtoM);
+        } else {
+            times.tOut[event.ped] = event.frame;
+            times.exitPoint[event.ped].x(event.x * CMtoM);
+            times.exitPoint[event.ped].y(event.y * CMtoM);
+        }
+    }
+    return times;
+}
+
+std::vector<int> EntryExitIndex::NumberInside(int area, int numFrames) const
+{
+    // +1 in the frame of the entry, -1 in the frame of the exit or after the last frame
+    std::vector<int> changes(numFrames + 1, 0);
+    const ConstSpan<EntryExitEvent> events = Events(area);
+    for(std::size_t i = 0; i < events.size(); i++) {
+        const EntryExitEvent & event = events[i];
+        if(!event.entry || event.frame >= numFrames) {
+            continue;
+        }
+        const bool exits = i + 1 < events.size() && events[i + 1].ped == event.ped;
+        const int end    = exits ? events[i + 1].frame : _endFrames[event.ped];
+        changes[event.frame]++;
+        changes[std::min(end, numFrames)]--;
+    }
+    std::vector<int> numberInside(numFrames, 0);
+    int inside = 0;
+    for(int frame = 0; frame < numFrames; frame++) {
+        inside += changes[frame];
+        numberInside[frame] = inside;
+    }
+    return numberInside;
+}
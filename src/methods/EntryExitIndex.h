@@ -0,0 +1,70 @@
+#pragma once
+
+#include "AreaPredicate.h"
+#include "TrajectoryStore.h"
+
+#include <vector>
+
+/// how entering and leaving a measurement area are detected
+enum class EntryExitRule {
+    // enters if covered by the area, leaves if not within it ("variant 4" of methods F, G and H)
+    CoveredByWithin,
+    // enters if within the area, leaves if not within it (method B)
+    Within
+};
+
+/// a pedestrian entering or leaving a measurement area
+struct EntryExitEvent {
+    int ped;
+    // frame of the entry or exit, an exit in frame 0 is detected in frame 1 (see EntryExitIndex)
+    int frame;
+    bool entry;
+    // position in cm, truncated to integers except for exits in frame 0
+    double x;
+    double y;
+};
+
+/// last entry into and exit from a measurement area of each pedestrian, 0 if there is none
+struct EntryExitTimes {
+    std::vector<int> tIn;
+    std::vector<int> tOut;
+    std::vector<point_2d> entrancePoint; // in m
+    std::vector<point_2d> exitPoint;     // in m
+};
+
+/**
+ * Entries into and exits from a set of measurement areas of all pedestrians.
+ *
+ * The trajectory of each pedestrian is swept once for all areas. The positions are truncated to
+ * integers before they are tested. A uniform grid over the envelopes of the areas skips the areas
+ * which are far from the bounding box of a trajectory. The events of each area are sorted by
+ * pedestrian and frame.
+ *
+ * With EntryExitRule::CoveredByWithin, a pedestrian which enters in frame 0 and leaves in frame 1
+ * is taken as leaving in frame 0 if its exact position in frame 0 is not within the area, i.e. its
+ * first position lies on the boundary.
+ */
+class EntryExitIndex
+{
+public:
+    EntryExitIndex(
+        const std::vector<const AreaPredicate *> & areas,
+        EntryExitRule rule,
+        TrajectoryView<double> xCor,
+        TrajectoryView<double> yCor);
+
+    /// events of the area at the position in the list of areas
+    ConstSpan<EntryExitEvent> Events(int area) const;
+
+    /// last entry and exit of each pedestrian detected before numFrames
+    EntryExitTimes GetTinTout(int area, int numFrames) const;
+
+    /// number of pedestrians between their entry and exit in each frame before numFrames
+    std::vector<int> NumberInside(int area, int numFrames) const;
+
+private:
+    int _numPeds;
+    std::vector<int> _endFrames; // frame after the last frame of each pedestrian
+    std::vector<std::size_t> _offsets;
+    std::vector<EntryExitEvent> _events;
+};
@@ -0,0 +1,109 @@
+#include "LineCrossing.h"
+
+#include "../general/Macros.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+/// distance to the line below which a pedestrian is "on the line"
+constexpr double OnLineDistance = 0.1;
+} // namespace
+
+LineCrossing::LineCrossing(double startX, double startY, double endX, double endY) :
+    _startX(startX), _startY(startY), _endX(endX), _endY(endY)
+{
+    const double maxAbs =
+        std::max({std::abs(startX), std::abs(startY), std::abs(endX), std::abs(endY)});
+    // far above the rounding errors of the distances of steps near the line
+    _tolerance = 1e-9 * (1 + maxAbs);
+
+    _length = std::hypot(endX - startX, endY - startY);
+    if(_length > 0) {
+        _ux = (endX - startX) / _length;
+        _uy = (endY - startY) / _length;
+        _nx = -_uy;
+        _ny = _ux;
+    }
+}
+
+int LineCrossing::Crossing(double x0, double y0, double x1, double y1) const
+{
+    // oriented distances to the line, positive left of it
+    const double d0     = _nx * (x0 - _startX) + _ny * (y0 - _startY);
+    const double d1     = _nx * (x1 - _startX) + _ny * (y1 - _startY);
+    const int direction = d1 < d0 ? -1 : 1;
+    if(_length == 0) {
+        return BoostCrossing(x0, y0, x1, y1) ? direction : 0;
+    }
+    if((d0 > _tolerance && d1 > _tolerance) || (d0 < -_tolerance && d1 < -_tolerance)) {
+        return 0;
+    }
+    if(std::abs(d0) <= _tolerance || std::abs(d1) <= _tolerance) {
+        return BoostCrossing(x0, y0, x1, y1) ? direction : 0;
+    }
+    // the step changes the side, the crossing point has to be within the extent of the line
+    const double s0 = _ux * (x0 - _startX) + _uy * (y0 - _startY);
+    const double s1 = _ux * (x1 - _startX) + _uy * (y1 - _startY);
+    const double s  = s0 + (s1 - s0) * d0 / (d0 - d1);
+    if(s > _tolerance && s < _length - _tolerance) {
+        return direction;
+    }
+    if(s < -_tolerance || s > _length + _tolerance) {
+        return 0;
+    }
+    return BoostCrossing(x0, y0, x1, y1) ? direction : 0;
+}
+
+double LineCrossing::Fraction(double x0, double y0, double x1, double y1) const
+{
+    const double d0 = _nx * (x0 - _startX) + _ny * (y0 - _startY);
+    const double d1 = _nx * (x1 - _startX) + _ny * (y1 - _startY);
+    if(d0 == d1) {
+        return 0;
+    }
+    return std::clamp(d0 / (d0 - d1), 0.0, 1.0);
+}
+
+void LineCrossing::Crossings(
+    const double * x0,
+    const double * y0,
+    const double * x1,
+    const double * y1,
+    std::size_t n,
+    std::int8_t * direction) const
+{
+    for(std::size_t i = 0; i < n; i++) {
+        direction[i] = Crossing(x0[i], y0[i], x1[i], y1[i]);
+    }
+}
+
+bool LineCrossing::IsOnLine(double x, double y) const
+{
+    const double distance = Distance(x, y);
+    if(std::abs(distance - OnLineDistance) > _tolerance) {
+        return distance < OnLineDistance;
+    }
+    const segment line(point_2d(_startX, _startY), point_2d(_endX, _endY));
+    return boost::geometry::distance(point_2d(x, y), line) < OnLineDistance;
+}
+
+double LineCrossing::Distance(double x, double y) const
+{
+    const double s = _ux * (x - _startX) + _uy * (y - _startY);
+    if(s <= 0) {
+        return std::hypot(x - _startX, y - _startY);
+    }
+    if(s >= _length) {
+        return std::hypot(x - _endX, y - _endY);
+    }
+    return std::abs(_nx * (x - _startX) + _ny * (y - _startY));
+}
+
+bool LineCrossing::BoostCrossing(double x0, double y0, double x1, double y1) const
+{
+    const segment line(point_2d(_startX, _startY), point_2d(_endX, _endY));
+    const segment step(point_2d(x0, y0), point_2d(x1, y1));
+    return boost::geometry::intersects(line, step);
+}
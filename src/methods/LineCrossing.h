@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Crossing tests of a measurement line with the results of boost::geometry::intersects and
+ * boost::geometry::distance for the segment of the line.
+ *
+ * The normal and the extent of the line are calculated once. A step of a pedestrian crosses the
+ * line if the oriented distance to the line changes its sign and the crossing point lies within
+ * the extent of the line. Steps which touch the line or its end points within the rounding errors
+ * of these values are tested with boost.
+ */
+class LineCrossing
+{
+public:
+    LineCrossing() = default;
+    LineCrossing(double startX, double startY, double endX, double endY);
+
+    /**
+     * direction of the step from (x0, y0) to (x1, y1) over the line
+     * @return 0 if the step does not touch the line, 1 if it goes to the left of the line
+     * (seen from start to end) or along it, -1 if it goes to the right of the line
+     */
+    int Crossing(double x0, double y0, double x1, double y1) const;
+
+    /**
+     * position of the crossing point on the step from (x0, y0) to (x1, y1) over the line
+     * @return 0 at (x0, y0), 1 at (x1, y1), 0 for steps along the line
+     */
+    double Fraction(double x0, double y0, double x1, double y1) const;
+
+    /// direction[i] = Crossing(x0[i], y0[i], x1[i], y1[i]) for n steps
+    void Crossings(
+        const double * x0,
+        const double * y0,
+        const double * x1,
+        const double * y1,
+        std::size_t n,
+        std::int8_t * direction) const;
+
+    /// the point is closer than 0.1 cm to the line
+    bool IsOnLine(double x, double y) const;
+
+private:
+    /// distance of the point to the line segment
+    double Distance(double x, double y) const;
+    /// crossing tested with boost::geometry::intersects
+    bool BoostCrossing(double x0, double y0, double x1, double y1) const;
+
+    double _startX = 0;
+    double _startY = 0;
+    double _endX   = 0;
+    double _endY   = 0;
+    // unit vector from start to end and the normal to the left of it
+    double _ux     = 0;
+    double _uy     = 0;
+    double _nx     = 0;
+    double _ny     = 0;
+    double _length = 0;
+    // steps closer to the line or its end points are tested with boost
+    double _tolerance = 0;
+};
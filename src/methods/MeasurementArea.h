@@ -28,6 +28,9 @@
 #ifndef MEASUREMENTAREA_H_
 #define MEASUREMENTAREA_H_
 
+#include "AreaPredicate.h"
+#include "LineCrossing.h"
+
 #include <boost/geometry/geometries/point_xy.hpp>
 #include <boost/geometry/geometries/polygon.hpp>
 #include <boost/geometry/geometries/ring.hpp>
@@ -51,6 +54,8 @@ class MeasurementArea_B : public MeasurementArea
 {
 public:
     polygon_2d _poly;
+    // point in polygon tests of _poly, has to be recreated when _poly changes
+    AreaPredicate _predicate;
     double _length           = -1.0;
     double _lengthOrthogonal = -1.0;
     // delta y for methods E and F (orthogonal to movement direction)
@@ -63,6 +68,8 @@ public:
     double _lineStartY;
     double _lineEndX;
     double _lineEndY;
+    // crossing tests of the line, has to be recreated when the line changes
+    LineCrossing _crossing;
 };
 
 #endif /* MEASUREMENTAREA_H_ */
@@ -43,7 +43,7 @@ Method_A::Method_A()
 {
     _classicFlow     = 0;
     _vDeltaT         = 0;
-    _passLine        = nullptr;
+    _crossings       = nullptr;
     _deltaT          = 100;
     _fps             = 16;
     _areaForMethod_A = nullptr;
@@ -61,25 +61,24 @@ bool Method_A::Process(
     _scriptsLocation = scriptsLocation;
     _outputLocation  = peddata.GetOutputLocation();
     _peds_t          = peddata.GetPedIDsByFrameNr();
-    _xCor            = peddata.GetXCor();
-    _yCor            = peddata.GetYCor();
-    _firstFrame      = peddata.GetFirstFrame();
     _fps             = peddata.GetFps();
     _measureAreaId   = boost::lexical_cast<string>(_areaForMethod_A->_id);
-    _passLine        = new bool[peddata.GetNumPeds()];
+    // pedestrians passing the line at another height are not counted
+    _passingFrame = _crossings->PassingFrames(
+        _areaForMethod_A->_id, peddata.GetNumPeds(), false, [&](int ped, int frame) {
+            return peddata.IsAtHeight(ped, frame, zPos_measureArea);
+        });
     string outputRhoV;
     outputRhoV.append(
         "#framerate:\t" + std::to_string(_fps) + "\n\n#Frame\tTime [s]\tCumulative pedestrians\n");
 
-    for(int i = 0; i < peddata.GetNumPeds(); i++) {
-        _passLine[i] = false;
-    }
     LOG_INFO("------------------------Analyzing with Method A-----------------------------");
     bool PedInGeometry = false;
-    for(std::map<int, std::vector<int>>::iterator ite = _peds_t.begin(); ite != _peds_t.end();
-        ite++) {
-        int frameNr = ite->first;                      // index starts by 0
-        int frid    = frameNr + peddata.GetMinFrame(); // frame in traj file
+    for(int frameNr = 0; frameNr < _peds_t.NumFrames(); frameNr++) { // index starts by 0
+        if(_peds_t[frameNr].empty()) {
+            continue;
+        }
+        int frid = frameNr + peddata.GetMinFrame(); // frame in traj file
         if(!(frid % 100)) {
             LOG_INFO("frame ID = {}", frid);
         }
@@ -105,7 +104,6 @@ bool Method_A::Process(
     } else {
         LOG_WARNING("No pedestrian exists on the plane of the selected Measurement area!!");
     }
-    delete[] _passLine;
     return true;
 }
 
@@ -137,20 +135,7 @@ void Method_A::GetAccumFlowVelocity(
     const std::unordered_map<int, int> & idToIndex)
 {
     for(auto const i : ids) {
-        bool IspassLine = false;
-        if(frame > _firstFrame[i] && !_passLine[i]) {
-            IspassLine = IsPassLine(
-                _areaForMethod_A->_lineStartX,
-                _areaForMethod_A->_lineStartY,
-                _areaForMethod_A->_lineEndX,
-                _areaForMethod_A->_lineEndY,
-                _xCor(i, frame - 1),
-                _yCor(i, frame - 1),
-                _xCor(i, frame),
-                _yCor(i, frame));
-        }
-        if(IspassLine == true) {
-            _passLine[i] = true;
+        if(_passingFrame[i] == frame) {
             _classicFlow++;
             _vDeltaT += VInFrame[idToIndex.at(i)];
         }
@@ -222,3 +207,8 @@ void Method_A::SetTimeInterval(int deltaT)
 {
     _deltaT = deltaT;
 }
+
+void Method_A::SetCrossingIndex(const CrossingIndex * crossings)
+{
+    _crossings = crossings;
+}
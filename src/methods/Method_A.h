@@ -29,17 +29,15 @@
 #define METHOD_A_H_
 
 #include "../general/Macros.h"
+#include "CrossingIndex.h"
 #include "MeasurementArea.h"
 #include "PedData.h"
 #include "tinyxml.h"
 
-#include <boost/numeric/ublas/io.hpp>
-#include <boost/numeric/ublas/matrix.hpp>
 #include <unordered_map>
 
 typedef boost::geometry::model::segment<boost::geometry::model::d2::point_xy<double>> segment;
 
-namespace ub = boost::numeric::ublas;
 using namespace boost::geometry;
 
 class Method_A
@@ -49,6 +47,7 @@ public:
     virtual ~Method_A();
     void SetMeasurementArea(MeasurementArea_L * area);
     void SetTimeInterval(int deltaT);
+    void SetCrossingIndex(const CrossingIndex * crossings);
     bool Process(
         const PedData & peddata,
         const fs::path & scriptsLocation,
@@ -58,6 +57,7 @@ private:
     fs::path _trajName;
     std::string _measureAreaId;
     MeasurementArea_L * _areaForMethod_A;
+    const CrossingIndex * _crossings;
 
     fs::path _projectRootDir;
     fs::path _scriptsLocation;
@@ -66,14 +66,10 @@ private:
     std::vector<int> _accumPedsPassLine; // the accumulative pedestrians pass a line with time
     std::vector<double>
         _accumVPassLine; // the accumulative instantaneous velocity of the pedestrians pass a line
-    std::map<int, std::vector<int>> _peds_t;
-
-    ub::matrix<double> _xCor;
-    ub::matrix<double> _yCor;
-    std::vector<int> _firstFrame;
+    FrameIndexView _peds_t;
     float _fps;
 
-    bool * _passLine;
+    std::vector<int> _passingFrame; // frame in which each pedestrian passes the line first
     int _classicFlow; // the number of pedestrians pass a line in a certain time
     double _vDeltaT; // define this is to measure cumulative velocity each pedestrian pass a measure
                      // line each time step to calculate the <v>delat T=sum<vi>/N
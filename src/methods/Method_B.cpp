@@ -29,6 +29,9 @@
 #include "Method_B.h"
 
 #include "../general/Logger.h"
+#include "EntryExitIndex.h"
+
+#include <algorithm>
 
 using std::string;
 using std::vector;
@@ -89,41 +92,20 @@ bool Method_B::Process(const PedData & peddata)
 
 void Method_B::GetTinTout(int numFrames)
 {
-    bool * IsinMeasurezone = new bool[_NumPeds];
-    for(int i = 0; i < _NumPeds; i++) {
-        IsinMeasurezone[i] = false;
-    }
-    _DensityPerFrame = new double[numFrames];
-    // Method_C method_C;
+    const EntryExitIndex entryExit(
+        {&_areaForMethod_B->_predicate}, EntryExitRule::Within, _xCor, _yCor);
+    const EntryExitTimes times = entryExit.GetTinTout(0, numFrames);
+    std::copy(times.tIn.begin(), times.tIn.end(), _tIn);
+    std::copy(times.tOut.begin(), times.tOut.end(), _tOut);
+    _entrancePoint = times.entrancePoint;
+    _exitPoint     = times.exitPoint;
+
+    const vector<int> pedsinMeasureArea = entryExit.NumberInside(0, numFrames);
+    _DensityPerFrame                    = new double[numFrames];
     for(int frameNr = 0; frameNr < numFrames; frameNr++) {
-        vector<int> ids       = _peds_t[frameNr];
-        int pedsinMeasureArea = 0;
-        for(unsigned int i = 0; i < ids.size(); i++) {
-            int ID = ids[i];
-            int x  = _xCor(ID, frameNr);
-            int y  = _yCor(ID, frameNr);
-            if(within(make<point_2d>((x), (y)), _areaForMethod_B->_poly)) {
-                pedsinMeasureArea++;
-            }
-            if(within(make<point_2d>((x), (y)), _areaForMethod_B->_poly) &&
-               !(IsinMeasurezone[ID])) {
-                _tIn[ID]            = frameNr;
-                IsinMeasurezone[ID] = true;
-                _entrancePoint[ID].x(x * CMtoM);
-                _entrancePoint[ID].y(y * CMtoM);
-            }
-            if((!within(make<point_2d>((x), (y)), _areaForMethod_B->_poly)) &&
-               IsinMeasurezone[ID]) {
-                _tOut[ID] = frameNr;
-                _exitPoint[ID].x(x * CMtoM);
-                _exitPoint[ID].y(y * CMtoM);
-                IsinMeasurezone[ID] = false;
-            }
-        }
         _DensityPerFrame[frameNr] =
-            pedsinMeasureArea / (area(_areaForMethod_B->_poly) * CMtoM * CMtoM);
+            pedsinMeasureArea[frameNr] / (area(_areaForMethod_B->_poly) * CMtoM * CMtoM);
     }
-    delete[] IsinMeasurezone;
 }
 
 void Method_B::GetFundamentalTinTout(
@@ -162,7 +144,7 @@ void Method_B::GetFundamentalTinTout(
                     _xCor(i, 0) - (_xCor(i, _tOut[i]) - _xCor(i, 0)) / (_tOut[i] - _tIn[i] * 1.0);
                 double predictedY =
                     _yCor(i, 0) - (_yCor(i, _tOut[i]) - _yCor(i, 0)) / (_tOut[i] - _tIn[i] * 1.0);
-                if(within(make<point_2d>(predictedX, predictedY), _areaForMethod_B->_poly)) {
+                if(_areaForMethod_B->_predicate.Within(predictedX, predictedY)) {
                     // this condition has to be adjusted if another variant is used for tIn/tOut!
                     // here within is used
                     continue;
@@ -32,11 +32,6 @@
 #include "Method_C.h"
 #include "PedData.h"
 
-#include <boost/numeric/ublas/io.hpp>
-#include <boost/numeric/ublas/matrix.hpp>
-namespace ub = boost::numeric::ublas;
-
-
 class Method_B
 {
 public:
@@ -50,12 +45,12 @@ private:
     fs::path _projectRootDir;
     fs::path _outputLocation;
     std::string _measureAreaId;
-    std::map<int, std::vector<int>> _peds_t;
+    FrameIndexView _peds_t;
     MeasurementArea_B * _areaForMethod_B;
     int _NumPeds;
     float _fps;
-    ub::matrix<double> _xCor;
-    ub::matrix<double> _yCor;
+    TrajectoryView<double> _xCor;
+    TrajectoryView<double> _yCor;
     int * _tIn;                           // the time for each pedestrian enter the measurement area
     int * _tOut;                          // the time for each pedestrian exit the measurement area
     std::vector<point_2d> _entrancePoint; // where pedestrian enters the measurement area
@@ -43,7 +43,10 @@ Method_C::Method_C()
 
 Method_C::~Method_C() {}
 
-bool Method_C::Process(const PedData & peddata, const double & zPos_measureArea)
+bool Method_C::Process(
+    const PedData & peddata,
+    const double & zPos_measureArea,
+    bool parallelFrames)
 {
     _peds_t         = peddata.GetPedIDsByFrameNr();
     _minFrame       = peddata.GetMinFrame();
@@ -54,20 +57,38 @@ bool Method_C::Process(const PedData & peddata, const double & zPos_measureArea)
     _fps            = peddata.GetFps();
     OpenFileMethodC();
     LOG_INFO("------------------------Analyzing with Method C-----------------------------");
-    for(auto ite = _peds_t.begin(); ite != _peds_t.end(); ite++) {
-        int frameNr = ite->first;
-        int frid    = frameNr + _minFrame;
+    // the frames are independent of each other, the rows are written in order afterwards
+    const double areaSize = area(_areaForMethod_C->_poly) * CMtoM * CMtoM;
+    std::vector<std::string> rows(_peds_t.NumFrames());
+#pragma omp parallel for schedule(dynamic) if(parallelFrames)
+    for(int frameNr = 0; frameNr < _peds_t.NumFrames(); frameNr++) {
+        IndexRange ids = _peds_t[frameNr];
+        if(ids.empty()) {
+            continue;
+        }
+        int frid = frameNr + _minFrame;
 
         if(!(frid % 100)) {
             LOG_INFO("frame ID = {}", frid);
         }
 
-        vector<int> ids               = _peds_t[frameNr];
-        vector<int> IdInFrame         = peddata.GetIdInFrame(frameNr, ids, zPos_measureArea);
         const vector<double> XInFrame = peddata.GetXInFrame(frameNr, ids, zPos_measureArea);
         const vector<double> YInFrame = peddata.GetYInFrame(frameNr, ids, zPos_measureArea);
         const vector<double> VInFrame = peddata.GetVInFrame(frameNr, ids, zPos_measureArea);
-        OutputClassicalResults(frameNr, IdInFrame.size(), XInFrame, YInFrame, VInFrame);
+        const auto [pedsInMeasureArea, sumVelocity] =
+            GetClassicalSums(XInFrame, YInFrame, VInFrame);
+        double ClassicDensity  = pedsInMeasureArea / areaSize;
+        double ClassicVelocity = 0;
+        if(pedsInMeasureArea != 0) {
+            ClassicVelocity = sumVelocity / (1.0 * pedsInMeasureArea);
+        }
+
+        char row[64];
+        snprintf(row, sizeof(row), "%05d\t%.3f\t%.3f\n", frid, ClassicDensity, ClassicVelocity);
+        rows[frameNr] = row;
+    }
+    for(const auto & row : rows) {
+        fputs(row.c_str(), _fClassicRhoV);
     }
     fclose(_fClassicRhoV);
     return true;
@@ -90,59 +111,23 @@ void Method_C::OpenFileMethodC()
         _fps);
 }
 
-void Method_C::OutputClassicalResults(
-    int frmNr,
-    int numPedsInFrame,
-    const vector<double> & XInFrame,
-    const vector<double> & YInFrame,
-    const vector<double> & VInFrame) const
-{
-    int frmId = frmNr + _minFrame;
-    std::ostringstream ss;
-    ss << std::setw(5) << std::setfill('0') << frmId;
-    const std::string str_frid = ss.str();
-    double ClassicDensity =
-        GetClassicalDensity(XInFrame, YInFrame, numPedsInFrame, _areaForMethod_C->_poly);
-    double ClassicVelocity = GetClassicalVelocity(XInFrame, YInFrame, VInFrame, numPedsInFrame);
-    fprintf(_fClassicRhoV, "%s\t%.3f\t%.3f\n", str_frid.c_str(), ClassicDensity, ClassicVelocity);
-}
-
-double Method_C::GetClassicalDensity(
-    const vector<double> & xs,
-    const vector<double> & ys,
-    int pednum,
-    polygon_2d measurearea) const
-{
-    int pedsinMeasureArea = 0;
-    for(int i = 0; i < pednum; i++) {
-        if(within(make<point_2d>(xs[i], ys[i]), measurearea)) {
-            pedsinMeasureArea++;
-        }
-    }
-
-    return pedsinMeasureArea / (area(_areaForMethod_C->_poly) * CMtoM * CMtoM);
-}
-
-double Method_C::GetClassicalVelocity(
+std::tuple<int, double> Method_C::GetClassicalSums(
     const vector<double> & xs,
     const vector<double> & ys,
-    const vector<double> & VInFrame,
-    int pednum) const
+    const vector<double> & VInFrame) const
 {
-    int pedsinMeasureArea = 0;
+    thread_local std::vector<std::uint8_t> inside;
+    inside.resize(xs.size());
+    _areaForMethod_C->_predicate.Within(xs.data(), ys.data(), xs.size(), inside.data());
+    int pedsInMeasureArea = 0;
     double velocity       = 0;
-    for(int i = 0; i < pednum; i++) {
-        if(within(make<point_2d>(xs[i], ys[i]), _areaForMethod_C->_poly)) {
+    for(std::size_t i = 0; i < xs.size(); i++) {
+        if(inside[i]) {
             velocity += VInFrame[i];
-            pedsinMeasureArea++;
+            pedsInMeasureArea++;
         }
     }
-    if(pedsinMeasureArea != 0) {
-        velocity /= (1.0 * pedsinMeasureArea);
-    } else {
-        velocity = 0;
-    }
-    return velocity;
+    return {pedsInMeasureArea, velocity};
 }
 
 void Method_C::SetMeasurementArea(MeasurementArea_B * area)
@@ -31,17 +31,23 @@
 #include "../Analysis.h"
 #include "PedData.h"
 
+#include <tuple>
+
 
 class Method_C
 {
 public:
     Method_C();
     virtual ~Method_C();
-    bool Process(const PedData & peddata, const double & zPos_measureArea);
+    /**
+     * @param parallelFrames process the frames in parallel, the results are still written in
+     * frame order
+     */
+    bool Process(const PedData & peddata, const double & zPos_measureArea, bool parallelFrames);
     void SetMeasurementArea(MeasurementArea_B * area);
 
 private:
-    std::map<int, std::vector<int>> _peds_t;
+    FrameIndexView _peds_t;
     int _minFrame;
     std::string _measureAreaId;
     MeasurementArea_B * _areaForMethod_C;
@@ -53,22 +59,11 @@ private:
     float _fps;
     FILE * _fClassicRhoV;
     void OpenFileMethodC();
-    void OutputClassicalResults(
-        int frmNr,
-        int numPedsInFrame,
-        const std::vector<double> & XInFrame,
-        const std::vector<double> & YInFrame,
-        const std::vector<double> & VInFrame) const;
-    double GetClassicalVelocity(
+    /// number of pedestrians within the measurement area and the sum of their velocities
+    std::tuple<int, double> GetClassicalSums(
         const std::vector<double> & xs,
         const std::vector<double> & ys,
-        const std::vector<double> & VInFrame,
-        int pednum) const;
-    double GetClassicalDensity(
-        const std::vector<double> & xs,
-        const std::vector<double> & ys,
-        int pednum,
-        polygon_2d measurearea) const;
+        const std::vector<double> & VInFrame) const;
 };
 
 #endif /* METHOD_C_H_ */
@@ -31,54 +31,105 @@
 #include "../general/Logger.h"
 #include "../general/Macros.h"
 #include "ConfigData_D.h"
+#include "ConvexClipper.h"
+#include "PolygonIndex.h"
+#include "ProfileGrid.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdarg>
 #include <iostream>
 #include <map>
 #include <tuple>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#define omp_get_thread_num() 0
+#endif
+
 // using std::string;
 // using std::vector;
 // using std::ofstream;
 using namespace std;
 
+namespace
+{
+/// printf-like formatting appended to output
+void AppendFormat(std::string & output, const char * format, ...)
+{
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    const int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if(length < 0) {
+        va_end(argsCopy);
+        return;
+    }
+    if(static_cast<std::size_t>(length) < sizeof(buffer)) {
+        output.append(buffer, length);
+    } else {
+        const std::size_t offset = output.size();
+        output.resize(offset + length + 1);
+        vsnprintf(&output[offset], length + 1, format, argsCopy);
+        output.resize(offset + length);
+    }
+    va_end(argsCopy);
+}
+} // namespace
+
 
 Method_D::Method_D()
 {
-    _fps             = 16;
-    _geoMinX         = 0;
-    _geoMinY         = 0;
-    _geoMaxX         = 0;
-    _geoMaxY         = 0;
-    _fIndividualFD   = nullptr;
-    _fOutputRhoV     = nullptr;
-    _measurementArea = nullptr;
+    _fps                = 16;
+    _geoMinX            = 0;
+    _geoMinY            = 0;
+    _geoMaxX            = 0;
+    _geoMaxY            = 0;
+    _fIndividualFD      = nullptr;
+    _fOutputRhoV        = nullptr;
+    _measurementArea    = nullptr;
+    _startFrame         = -1;
+    _stopFrame          = -1;
+    _calcLocalIFD       = false;
+    _calcGlobalIFDOnly  = false;
+    _calcProfileOnly    = false;
+    _gridSizeX          = 0;
+    _gridSizeY          = 0;
+    _profileRows        = 0;
+    _profileColumns     = 0;
+    _profilePerFrame    = true;
+    _profileInterval    = 0;
+    _profileVariance    = false;
+    _profileOrigin      = 0;
+    _profileWindowIndex = -1;
+    _profileLastFrame   = 0;
+    _failed             = false;
 }
 
 Method_D::~Method_D() {}
 
-bool Method_D::Process(
+bool Method_D::Init(
     const ConfigData_D & configData,
     int measurementAreaIndex,
-    const PedData & pedData,
-    const double & zPos_measureArea)
+    const PedData & pedData)
 {
     // TODO: lots of these parameters should be initialized in the constructor
     bool return_value = true;
     _outputLocation   = pedData.GetOutputLocation();
-    _pedIDsByFrameNr  = pedData.GetPedIDsByFrameNr();
     _trajName         = pedData.GetTrajName();
     _projectRootDir   = pedData.GetProjectRootDir();
     _fps              = pedData.GetFps();
     int minFrame      = pedData.GetMinFrame();
 
-    auto _startFrame   = configData.startFrames[measurementAreaIndex];
-    auto _stopFrame    = configData.stopFrames[measurementAreaIndex];
-    auto _calcLocalIFD = configData.calcLocalIFD[measurementAreaIndex];
-
-    auto _isOneDimensional = configData.isOneDimensional;
-    auto _useBlindPoints   = configData.useBlindPoints;
+    _startFrame   = configData.startFrames[measurementAreaIndex];
+    _stopFrame    = configData.stopFrames[measurementAreaIndex];
+    _calcLocalIFD = configData.calcLocalIFD[measurementAreaIndex];
 
     _velocityCalcFunc = configData.velocityCalcFunc;
     _densityType      = configData.densityType;
@@ -88,8 +139,8 @@ bool Method_D::Process(
     // measurement areas
     // TODO: should be changed in future. There should be a function for processing global data
     // (once) which are measurement area independent
-    bool _calcProfileOnly   = false;
-    bool _calcGlobalIFDOnly = false;
+    _calcProfileOnly   = false;
+    _calcGlobalIFDOnly = false;
 
     if(_measurementArea->_id == -1) {
         // change parameters for calculating global IFD only
@@ -112,32 +163,81 @@ bool Method_D::Process(
         if(_stopFrame == -1) {
             _stopFrame = pedData.GetNumFrames() + minFrame;
         }
-        for(std::map<int, std::vector<int>>::iterator ite = _pedIDsByFrameNr.begin();
-            ite != _pedIDsByFrameNr.end();) {
-            if((ite->first + minFrame) < _startFrame || (ite->first + minFrame) > _stopFrame) {
-                ite = _pedIDsByFrameNr.erase(ite);
-            } else {
-                ++ite;
-            }
-        }
+    }
+
+    if(_calcProfileOnly) {
+        _gridSizeX = configData.gridSizeX;
+        _gridSizeY = configData.gridSizeY;
+        // the number of rows and columns that the geometry will be discretized for field analysis
+        _profileRows     = (int) ceil((_geoMaxY - _geoMinY) / _gridSizeY);
+        _profileColumns  = (int) ceil((_geoMaxX - _geoMinX) / _gridSizeX);
+        _profilePerFrame = configData.profilePerFrame;
+        _profileInterval = configData.profileInterval;
+        _profileVariance = configData.profileVariance;
+        _profileOrigin   = _startFrame == _stopFrame ? minFrame : _startFrame;
     }
 
     // open file for general Method D output. should not be done if global_IFD or profile option is
     // enabled
-    if(!_calcGlobalIFDOnly && !_calcProfileOnly && !OpenFileMethodD(_isOneDimensional)) {
+    if(!_calcGlobalIFDOnly && !_calcProfileOnly && !OpenFileMethodD(configData.isOneDimensional)) {
         return_value = false;
     }
 
     // open file for IFD output
     if(_calcLocalIFD || _calcGlobalIFDOnly) {
-        if(!OpenFileIndividualFD(_isOneDimensional, _calcGlobalIFDOnly)) {
+        if(!OpenFileIndividualFD(configData.isOneDimensional, _calcGlobalIFDOnly)) {
             return_value = false;
         }
     }
+    return return_value;
+}
+
+bool Method_D::IsInFrameRange(int frid) const
+{
+    // frames outside of [start, stop] are skipped
+    return _startFrame == _stopFrame || (frid >= _startFrame && frid <= _stopFrame);
+}
+
+std::vector<bool> Method_D::Process(
+    const ConfigData_D & configData,
+    std::vector<Method_D> & methods,
+    const std::vector<int> & measurementAreaIndices,
+    const PedData & pedData,
+    const double & zPos_measureArea,
+    bool parallelFrames)
+{
+    std::vector<bool> results(methods.size());
+    for(std::size_t i = 0; i < methods.size(); i++) {
+        results[i] = methods[i].Init(configData, measurementAreaIndices[i], pedData);
+    }
+    if(methods.empty()) {
+        return results;
+    }
+    // the Voronoi diagrams of the room are calculated for all measurement areas in it
+    Method_D & room                 = methods.front();
+    const FrameIndex & pedsInFrames = pedData.GetPedIDsByFrameNr();
+    const int minFrame              = pedData.GetMinFrame();
+
     LOG_INFO("------------------------Analyzing with Method D-----------------------------");
-    for(const auto & ite : _pedIDsByFrameNr) {
-        int frameNr = ite.first;
-        int frid    = frameNr + minFrame;
+    const int numFrames = pedsInFrames.NumFrames();
+    // one diagram per thread, its buffers are reused for all frames handled by the thread
+    std::vector<VoronoiDiagram> diagrams(parallelFrames ? omp_get_max_threads() : 1);
+#pragma omp parallel for schedule(dynamic) ordered if(parallelFrames)
+    for(int frameNr = 0; frameNr < numFrames; frameNr++) {
+        IndexRange ids = pedsInFrames[frameNr];
+        int frid       = frameNr + minFrame;
+        if(ids.empty()) {
+            continue;
+        }
+        std::vector<std::size_t> areasInFrame;
+        for(std::size_t i = 0; i < methods.size(); i++) {
+            if(methods[i].IsInFrameRange(frid)) {
+                areasInFrame.push_back(i);
+            }
+        }
+        if(areasInFrame.empty()) {
+            continue;
+        }
         // padd the frameid with 0
         std::ostringstream ss;
         ss << std::setw(5) << std::setfill('0') << std::internal << frid;
@@ -145,7 +245,6 @@ bool Method_D::Process(
         if((frid % 50) == 0) {
             LOG_INFO("frame ID = {}", frid);
         }
-        vector<int> ids         = _pedIDsByFrameNr[frameNr];
         vector<int> IdInFrame   = pedData.GetIdInFrame(frameNr, ids, zPos_measureArea);
         vector<double> XInFrame = pedData.GetXInFrame(frameNr, ids, zPos_measureArea);
         vector<double> YInFrame = pedData.GetYInFrame(frameNr, ids, zPos_measureArea);
@@ -160,7 +259,7 @@ bool Method_D::Process(
         //------------------------------Remove peds outside
         // geometry------------------------------------------
         for(size_t i = 0; i < static_cast<size_t>(IdInFrame.size()); i++) {
-            if(!within(point_2d(round(XInFrame[i]), round(YInFrame[i])), _geoPoly)) {
+            if(!within(point_2d(round(XInFrame[i]), round(YInFrame[i])), room._geoPoly)) {
                 LOG_WARNING(
                     "Pedestrian with id <{}> at <x={:.4f}, y={:.4f}, z={:.4f}> is not in the "
                     "geometry and will not be"
@@ -178,29 +277,38 @@ bool Method_D::Process(
             }
         }
         int numPeds = IdInFrame.size();
+        std::vector<FrameOutput> outputs(methods.size());
 
         //---------------------------------------------------------------------------------------------------------------
-        if((numPeds > 3) || _useBlindPoints) {
-            if(_isOneDimensional) {
-                CalcVoronoiResults1D(
-                    XInFrame,
-                    VInFrame,
-                    IdInFrame,
-                    _measurementArea->_poly,
-                    str_frid,
-                    _calcLocalIFD);
+        if((numPeds > 3) || configData.useBlindPoints) {
+            if(configData.isOneDimensional) {
+                for(std::size_t i : areasInFrame) {
+                    methods[i].CalcVoronoiResults1D(
+                        XInFrame,
+                        VInFrame,
+                        IdInFrame,
+                        methods[i]._measurementArea->_poly,
+                        str_frid,
+                        methods[i]._calcLocalIFD,
+                        outputs[i]);
+                }
             } else {
                 // TODO: not sure what is happening here?? Positions are shifted when they are on
                 // the same line?
-                if(numPeds > 1 && ArePointsOnOneLine(XInFrame, YInFrame)) {
+                if(numPeds > 1 && room.ArePointsOnOneLine(XInFrame, YInFrame)) {
                     if(fabs(XInFrame[1] - XInFrame[0]) < DMIN) {
                         XInFrame[1] += JPS_OFFSET;
                     } else {
                         YInFrame[1] += JPS_OFFSET;
                     }
                 }
-                std::vector<std::pair<polygon_2d, int>> polygons_id =
-                    GetPolygons(configData, XInFrame, YInFrame, VInFrame, IdInFrame);
+                std::vector<std::pair<polygon_2d, int>> polygons_id = room.GetPolygons(
+                    configData,
+                    diagrams[omp_get_thread_num()],
+                    XInFrame,
+                    YInFrame,
+                    VInFrame,
+                    IdInFrame);
 
                 vector<polygon_2d> polygons;
                 polygons.reserve(polygons_id.size());
@@ -208,30 +316,17 @@ bool Method_D::Process(
                     polygons.push_back(p.first);
 
                 if(!polygons.empty()) {
-                    // no voronoi output or global options
-                    if(!_calcGlobalIFDOnly && !_calcProfileOnly) {
-                        OutputVoronoiResults(polygons, str_frid, VInFrame); // TODO polygons_id
-                    }
-
-                    // write IFD output
-                    if(_calcLocalIFD || _calcGlobalIFDOnly) {
-                        if(!_isOneDimensional) {
-                            GetIndividualFD(
-                                polygons,
-                                VInFrame,
-                                IdInFrame,
-                                _measurementArea->_poly,
-                                str_frid,
-                                XInFrame,
-                                YInFrame,
-                                ZInFrame,
-                                _calcGlobalIFDOnly);
-                        }
-                    }
-
-                    // write profile output
-                    if(_calcProfileOnly) {
-                        GetProfiles(configData, str_frid, polygons, VInFrame); // TODO polygons_id
+                    const PolygonIndex cells(polygons);
+                    for(std::size_t i : areasInFrame) {
+                        methods[i].OutputFrameResults(
+                            cells,
+                            str_frid,
+                            VInFrame,
+                            IdInFrame,
+                            XInFrame,
+                            YInFrame,
+                            ZInFrame,
+                            outputs[i]);
                     }
                 } else {
                     LOG_WARNING(
@@ -250,14 +345,65 @@ bool Method_D::Process(
                 frid,
                 minFrame);
         }
+#pragma omp ordered
+        for(std::size_t i : areasInFrame) {
+            methods[i].WriteFrameOutput(frid, outputs[i]);
+        }
+    }
+    for(std::size_t i = 0; i < methods.size(); i++) {
+        methods[i].WriteProfileWindow();
+        methods[i].CloseFiles();
+        results[i] = results[i] && !methods[i]._failed;
     }
+    return results;
+}
+
+void Method_D::OutputFrameResults(
+    const PolygonIndex & cells,
+    const std::string & frid,
+    const std::vector<double> & VInFrame,
+    const std::vector<int> & IdInFrame,
+    const std::vector<double> & XInFrame,
+    const std::vector<double> & YInFrame,
+    const std::vector<double> & ZInFrame,
+    FrameOutput & output)
+{
+    // no voronoi output or global options
     if(!_calcGlobalIFDOnly && !_calcProfileOnly) {
-        fclose(_fOutputRhoV);
+        OutputVoronoiResults(cells, frid, VInFrame, output.rhoV); // TODO polygons_id
     }
+
+    // write IFD output
     if(_calcLocalIFD || _calcGlobalIFDOnly) {
+        GetIndividualFD(
+            cells,
+            VInFrame,
+            IdInFrame,
+            _measurementArea->_poly,
+            frid,
+            XInFrame,
+            YInFrame,
+            ZInFrame,
+            _calcGlobalIFDOnly,
+            output.individualFD);
+    }
+
+    // write profile output
+    if(_calcProfileOnly) {
+        GetProfiles(frid, cells, VInFrame, output); // TODO polygons_id
+    }
+}
+
+void Method_D::CloseFiles()
+{
+    if(_fOutputRhoV != nullptr) {
+        fclose(_fOutputRhoV);
+        _fOutputRhoV = nullptr;
+    }
+    if(_fIndividualFD != nullptr) {
         fclose(_fIndividualFD);
+        _fIndividualFD = nullptr;
     }
-    return return_value;
 }
 
 bool Method_D::OpenFileMethodD(bool _isOneDimensional)
@@ -335,27 +481,30 @@ bool Method_D::OpenFileIndividualFD(bool _isOneDimensional, bool global)
 
 std::vector<std::pair<polygon_2d, int>> Method_D::GetPolygons(
     const ConfigData_D & configData,
+    VoronoiDiagram & vd,
     vector<double> & XInFrame,
     vector<double> & YInFrame,
     vector<double> & VInFrame,
     vector<int> & IdInFrame)
 {
-    VoronoiDiagram vd;
-
     // get range for bounding box around the geoemtry
     double boundpoint =
         10 * max(max(fabs(_geoMinX), fabs(_geoMinY)), max(fabs(_geoMaxX), fabs(_geoMaxY)));
-    std::vector<std::pair<polygon_2d, int>> polygons_id;
-    polygons_id = vd.getVoronoiPolygons(XInFrame, YInFrame, VInFrame, IdInFrame, boundpoint);
+    // the diagram is reused for the following frames, its memory grows to the largest frame
+    vd.reserve(XInFrame.size());
+    const std::vector<std::pair<polygon_2d, int>> & cells =
+        vd.getVoronoiPolygons(XInFrame, YInFrame, VInFrame, IdInFrame, boundpoint);
 
     polygon_2d poly;
+    std::vector<std::pair<polygon_2d, int>> polygons_id;
     if(configData.cutByCircle) {
         polygons_id = vd.cutPolygonsWithCircle(
-            polygons_id, XInFrame, YInFrame, configData.cutRadius, configData.circleEdges);
+            cells, XInFrame, YInFrame, configData.cutRadius, configData.circleEdges);
+        polygons_id = vd.cutPolygonsWithGeometry(polygons_id, _geoPoly, XInFrame, YInFrame);
+    } else {
+        polygons_id = vd.cutPolygonsWithGeometry(cells, _geoPoly, XInFrame, YInFrame);
     }
 
-    polygons_id = vd.cutPolygonsWithGeometry(polygons_id, _geoPoly, XInFrame, YInFrame);
-
     for(auto && p : polygons_id) {
         poly = p.first;
         ReducePrecision(poly);
@@ -367,14 +516,31 @@ std::vector<std::pair<polygon_2d, int>> Method_D::GetPolygons(
  * Output the Voronoi density and velocity in the corresponding file
  */
 void Method_D::OutputVoronoiResults(
-    const polygon_list & polygons,
+    const PolygonIndex & cells,
     const string & frid,
-    const vector<double> & VInFrame)
+    const vector<double> & VInFrame,
+    string & output)
 {
     auto [voronoiDensity, voronoiVelocity] =
-        CalcDensityVelocity(polygons, VInFrame, _measurementArea->_poly);
+        CalcDensityVelocity(cells, VInFrame, _measurementArea->_poly);
+
+    AppendFormat(output, "%s\t%.3f\t%.3f\n", frid.c_str(), voronoiDensity, voronoiVelocity);
+}
 
-    fprintf(_fOutputRhoV, "%s\t%.3f\t%.3f\n", frid.c_str(), voronoiDensity, voronoiVelocity);
+void Method_D::WriteFrameOutput(int frid, const FrameOutput & output)
+{
+    if(output.failed) {
+        _failed = true;
+    }
+    if(!output.profileDensity.empty()) {
+        AddToProfileWindow(frid, output);
+    }
+    if(!output.rhoV.empty()) {
+        fputs(output.rhoV.c_str(), _fOutputRhoV);
+    }
+    if(!output.individualFD.empty()) {
+        fputs(output.individualFD.c_str(), _fIndividualFD);
+    }
 }
 
 /**
@@ -384,19 +550,24 @@ void Method_D::OutputVoronoiResults(
  * measurement area (tuple)
  */
 std::tuple<double, double> Method_D::CalcDensityVelocity(
-    const polygon_list & polygons,
+    const PolygonIndex & cells,
     const vector<double> & VInFrame,
     const polygon_2d & measurementArea)
 {
+    const polygon_list & polygons = cells.Polygons();
     double voronoiVelocity = 1;
     double voronoiDensity  = -1;
     polygon_list intersectingPolygons;
     vector<double> correspondingVelocities;
     double density = 0;
+    const ConvexClipper clipper(measurementArea);
+    polygon_list currentIntersectingPolygon;
+    // only cells with an envelope overlapping the one of the area can intersect it
+    thread_local std::vector<std::size_t> candidates;
+    cells.Query(measurementArea, candidates);
 
-    for(std::size_t i = 0; i < polygons.size(); ++i) {
-        polygon_list currentIntersectingPolygon;
-        intersection(measurementArea, polygons[i], currentIntersectingPolygon);
+    for(std::size_t i : candidates) {
+        clipper.Intersection(polygons[i], currentIntersectingPolygon);
 
         if(!currentIntersectingPolygon.empty()) {
             // intersection of voronoi cell with MA
@@ -440,92 +611,142 @@ std::tuple<double, double> Method_D::CalcDensityVelocity(
 
 // and velocity is calculated for every frame
 void Method_D::GetProfiles(
-    const ConfigData_D & configData,
     const string & frameId,
-    const polygon_list & polygons,
-    const vector<double> & velocity)
+    const PolygonIndex & cells,
+    const vector<double> & velocity,
+    FrameOutput & output)
+{
+    // each Voronoi cell only visits the grid cells touched by its bounding box
+    ProfileGrid grid(_geoMinX, _geoMaxY, _gridSizeX, _gridSizeY, _profileRows, _profileColumns);
+    const polygon_list & polygons = cells.Polygons();
+    for(std::size_t i = 0; i < polygons.size(); i++) {
+        grid.Add(polygons[i], velocity[i]);
+    }
+
+    // _velocityCalcFunc needs the intersections of all cells at once, the grid sums up both of
+    // its variants per grid cell instead
+    const bool arithmeticVelocity = _velocityType == "Arithmetic";
+    std::vector<double> densities(_profileRows * _profileColumns);
+    std::vector<double> velocities(_profileRows * _profileColumns);
+    for(int row_i = 0; row_i < _profileRows; row_i++) {
+        for(int colum_j = 0; colum_j < _profileColumns; colum_j++) {
+            const int index   = row_i * _profileColumns + colum_j;
+            densities[index]  = grid.Density(row_i, colum_j);
+            velocities[index] = arithmeticVelocity ? grid.ArithmeticVelocity(row_i, colum_j) :
+                                                     grid.VoronoiVelocity(row_i, colum_j);
+        }
+    }
+
+    if(_profilePerFrame &&
+       (!WriteProfile(ProfilePath("velocity", "Profile_v_" + _velocityType, frameId), velocities) ||
+        !WriteProfile(ProfilePath("density", "Profile_rho_" + _densityType, frameId), densities))) {
+        output.failed = true;
+    }
+    if(_profileInterval > 0) {
+        output.profileDensity  = std::move(densities);
+        output.profileVelocity = std::move(velocities);
+    }
+}
+
+void Method_D::AddToProfileWindow(int frid, const FrameOutput & output)
 {
-    float _grid_size_X = configData.gridSizeX;
-    float _grid_size_Y = configData.gridSizeY;
+    const int windowIndex = (frid - _profileOrigin) / _profileInterval;
+    if(windowIndex != _profileWindowIndex) {
+        WriteProfileWindow();
+        _profileWindowIndex = windowIndex;
+    }
+    _densityWindow.Add(output.profileDensity);
+    _velocityWindow.Add(output.profileVelocity);
+    _profileLastFrame = frid;
+}
 
+void Method_D::WriteProfileWindow()
+{
+    if(_densityWindow.NumFrames() == 0) {
+        return;
+    }
+    const int firstFrame = _profileOrigin + _profileWindowIndex * _profileInterval;
+    // the last interval ends with the last frame of the data
+    const int lastFrame = std::min(firstFrame + _profileInterval - 1, _profileLastFrame);
+    std::string frames;
+    AppendFormat(frames, "%05d-%05d", firstFrame, lastFrame);
+    LOG_INFO(
+        "write profiles of frames {} to {} averaged over {} frames",
+        firstFrame,
+        lastFrame,
+        _densityWindow.NumFrames());
+
+    const fs::path velocityFile = ProfilePath("velocity", "Profile_v_" + _velocityType, frames);
+    const fs::path densityFile = ProfilePath("density", "Profile_rho_" + _densityType, frames);
+    bool written = WriteProfile(velocityFile, _velocityWindow.Mean()) &&
+                   WriteProfile(densityFile, _densityWindow.Mean());
+    if(written && _profileVariance) {
+        written = WriteProfile(
+                      ProfilePath("velocity", "Profile_v_var_" + _velocityType, frames),
+                      _velocityWindow.Variance()) &&
+                  WriteProfile(
+                      ProfilePath("density", "Profile_rho_var_" + _densityType, frames),
+                      _densityWindow.Variance());
+    }
+    if(!written) {
+        _failed = true;
+    }
+    _densityWindow.Clear();
+    _velocityWindow.Clear();
+}
+
+fs::path Method_D::ProfilePath(
+    const std::string & quantity,
+    const std::string & prefix,
+    const std::string & frames) const
+{
     std::string voroLocation(VORO_LOCATION);
-    fs::path tmp("field");
-    fs::path vtmp("velocity");
-    fs::path dtmp("density");
-    tmp  = _outputLocation / voroLocation / tmp;
-    vtmp = tmp / vtmp /
-           ("Profile_v_" + _velocityType + "_" + _trajName.string() + "_" + frameId + ".dat");
-    dtmp = tmp / dtmp /
-           ("Profile_rho_" + _densityType + "_" + _trajName.string() + "_" + frameId + ".dat");
-    string Prfvelocity = vtmp.string();
-    string Prfdensity  = dtmp.string();
-
-    FILE * Prf_velocity;
-    if((Prf_velocity = Analysis::CreateFile(Prfvelocity)) == nullptr) {
-        LOG_ERROR("cannot open the file {} to write the field data", Prfvelocity);
-        exit(EXIT_FAILURE);
-    }
-    FILE * Prf_density;
-    if((Prf_density = Analysis::CreateFile(Prfdensity)) == nullptr) {
-        LOG_ERROR("cannot open the file to write the field density");
-        exit(EXIT_FAILURE);
-    }
-
-    int NRow =
-        (int) ceil((_geoMaxY - _geoMinY) / _grid_size_Y); // the number of rows that the geometry
-                                                          // will be discretized for field analysis
-    int NColumn =
-        (int) ceil((_geoMaxX - _geoMinX) / _grid_size_X); // the number of columns that the geometry
-                                                          // will be discretized for field analysis
-    for(int row_i = 0; row_i < NRow; row_i++) {           //
-        for(int colum_j = 0; colum_j < NColumn; colum_j++) {
-            polygon_2d measurezoneXY;
-            {
-                const double coor[][2] = {
-                    {_geoMinX + colum_j * _grid_size_X, _geoMaxY - row_i * _grid_size_Y},
-                    {_geoMinX + colum_j * _grid_size_X + _grid_size_X,
-                     _geoMaxY - row_i * _grid_size_Y},
-                    {_geoMinX + colum_j * _grid_size_X + _grid_size_X,
-                     _geoMaxY - row_i * _grid_size_Y - _grid_size_Y},
-                    {_geoMinX + colum_j * _grid_size_X,
-                     _geoMaxY - row_i * _grid_size_Y - _grid_size_Y},
-                    {_geoMinX + colum_j * _grid_size_X,
-                     _geoMaxY - row_i * _grid_size_Y} // closing point is opening point
-                };
-                assign_points(measurezoneXY, coor);
-            }
-            correct(measurezoneXY); // Polygons should be closed, and directed clockwise. If you're
-                                    // not sure if that is the case, call this function
-            auto [densityXY, velocityXY] = CalcDensityVelocity(polygons, velocity, measurezoneXY);
-            fprintf(Prf_density, "%.3f\t", densityXY);
-            fprintf(Prf_velocity, "%.3f\t", velocityXY);
+    return _outputLocation / voroLocation / "field" / quantity /
+           (prefix + "_" + _trajName.string() + "_" + frames + ".dat");
+}
+
+bool Method_D::WriteProfile(const fs::path & file, const std::vector<double> & values) const
+{
+    FILE * profile = Analysis::CreateFile(file.string());
+    if(profile == nullptr) {
+        LOG_ERROR("cannot open the file {} to write the field data", file.string());
+        return false;
+    }
+    std::string output;
+    for(int row_i = 0; row_i < _profileRows; row_i++) {
+        for(int colum_j = 0; colum_j < _profileColumns; colum_j++) {
+            AppendFormat(output, "%.3f\t", values[row_i * _profileColumns + colum_j]);
         }
-        fprintf(Prf_density, "\n");
-        fprintf(Prf_velocity, "\n");
+        output += "\n";
     }
-    fclose(Prf_velocity);
-    fclose(Prf_density);
+    fputs(output.c_str(), profile);
+    fclose(profile);
+    return true;
 }
 
 void Method_D::GetIndividualFD(
-    const polygon_list & polygon,
+    const PolygonIndex & cells,
     const vector<double> & Velocity,
     const vector<int> & Id,
     const polygon_2d & measureArea,
     const string & frid,
-    vector<double> & XInFrame,
-    vector<double> & YInFrame,
-    vector<double> & ZInFrame,
-    bool global)
+    const vector<double> & XInFrame,
+    const vector<double> & YInFrame,
+    const vector<double> & ZInFrame,
+    bool global,
+    string & output)
 {
     double uniquedensity  = 0;
     double uniquevelocity = 0;
     double x, y, z;
     int uniqueId = 0;
-    int temp     = 0;
-    for(const auto & polygon_iterator : polygon) {
-        polygon_list v;
-        intersection(measureArea, polygon_iterator, v);
+    const ConvexClipper clipper(measureArea);
+    polygon_list v;
+    thread_local std::vector<std::size_t> candidates;
+    cells.Query(measureArea, candidates);
+    for(std::size_t temp : candidates) {
+        const polygon_2d & polygon_iterator = cells.Polygons()[temp];
+        clipper.Intersection(polygon_iterator, v);
         if(!v.empty()) {
             string polygon_str = polygon_to_string(polygon_iterator);
 
@@ -539,8 +760,8 @@ void Method_D::GetIndividualFD(
 
             if(global) {
                 // no need to print inersection polygon
-                fprintf(
-                    _fIndividualFD,
+                AppendFormat(
+                    output,
                     "%s\t %d\t %.4f\t %.4f\t %.4f\t %.4f\t %.4f\t%s\n",
                     frid.c_str(),
                     uniqueId,
@@ -553,8 +774,8 @@ void Method_D::GetIndividualFD(
             } else {
                 // print intersection polygons as well
                 string v_str = polygon_to_string(v[0]);
-                fprintf(
-                    _fIndividualFD,
+                AppendFormat(
+                    output,
                     "%s\t %d\t %.4f\t %.4f\t %.4f\t %.4f\t %.4f\t%s\t%s\n",
                     frid.c_str(),
                     uniqueId,
@@ -567,7 +788,6 @@ void Method_D::GetIndividualFD(
                     v_str.c_str());
             }
         }
-        temp++;
     }
 }
 
@@ -598,12 +818,13 @@ void Method_D::ReducePrecision(polygon_2d & polygon)
 }
 
 void Method_D::CalcVoronoiResults1D(
-    vector<double> & XInFrame,
-    vector<double> & VInFrame,
-    vector<int> & IdInFrame,
+    const vector<double> & XInFrame,
+    const vector<double> & VInFrame,
+    const vector<int> & IdInFrame,
     const polygon_2d & measureArea,
     const string & frid,
-    bool _calcIndividualFD)
+    bool _calcIndividualFD,
+    FrameOutput & output)
 {
     vector<double> measurearea_x;
     for(unsigned int i = 0; i < measureArea.outer().size(); i++) {
@@ -655,8 +876,8 @@ void Method_D::CalcVoronoiResults1D(
         if(_calcIndividualFD) {
             double headway           = (XRightNeighbor[i] - XInFrame[i]) * CMtoM;
             double individualDensity = 2.0 / ((XRightNeighbor[i] - XLeftNeighbor[i]) * CMtoM);
-            fprintf(
-                _fIndividualFD,
+            AppendFormat(
+                output.individualFD,
                 "%s\t%d\t%.3f\t%.3f\t%.3f\n",
                 frid.c_str(),
                 IdInFrame[i],
@@ -667,7 +888,8 @@ void Method_D::CalcVoronoiResults1D(
     }
     VoronoiDensity /= ((right_boundary - left_boundary) * CMtoM);
     VoronoiVelocity /= ((right_boundary - left_boundary) * CMtoM);
-    fprintf(_fOutputRhoV, "%s\t%.3f\t%.3f\n", frid.c_str(), VoronoiDensity, VoronoiVelocity);
+    AppendFormat(
+        output.rhoV, "%s\t%.3f\t%.3f\n", frid.c_str(), VoronoiDensity, VoronoiVelocity);
 }
 
 double Method_D::getOverlapRatio(
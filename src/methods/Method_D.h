@@ -31,6 +31,8 @@
 #include "../Analysis.h"
 #include "ConfigData_D.h"
 #include "PedData.h"
+#include "PolygonIndex.h"
+#include "ProfileGrid.h"
 #include "VoronoiDiagram.h"
 
 
@@ -39,17 +41,38 @@ class Method_D
 public:
     Method_D();
     virtual ~Method_D();
-    bool Process(
+    /**
+     * Processes measurement areas which are in the same room and at the same height. The Voronoi
+     * diagram of each frame is calculated once and used for all of these measurement areas.
+     * @param methods one instance per measurement area, with geometry and measurement area set
+     * @param measurementAreaIndices index of the measurement area of each instance in configData
+     * @param parallelFrames process the frames in parallel, the results are still written in
+     * frame order
+     * @return success of each measurement area
+     */
+    static std::vector<bool> Process(
         const ConfigData_D & configData,
-        int measurementAreaIndex,
+        std::vector<Method_D> & methods,
+        const std::vector<int> & measurementAreaIndices,
         const PedData & pedData,
-        const double & zPos_measureArea);
+        const double & zPos_measureArea,
+        bool parallelFrames);
     void SetGeometryPolygon(polygon_2d geometryPolygon);
     void SetGeometryBoundaries(double minX, double minY, double maxX, double maxY);
     void SetMeasurementArea(MeasurementArea_B * area);
 
 private:
-    std::map<int, std::vector<int>> _pedIDsByFrameNr;
+    /// Results of one frame, which are written in frame order
+    struct FrameOutput {
+        std::string rhoV;
+        std::string individualFD;
+        // profiles of the frame, only kept if they are averaged over an interval
+        std::vector<double> profileDensity;
+        std::vector<double> profileVelocity;
+        // an output file of the frame could not be written
+        bool failed = false;
+    };
+
     MeasurementArea_B * _measurementArea;
     fs::path _trajName;
     fs::path _projectRootDir;
@@ -69,49 +92,100 @@ private:
     FILE * _fOutputRhoV;
     FILE * _fIndividualFD;
     float _fps;
+    int _startFrame;
+    int _stopFrame;
+    bool _calcLocalIFD;
+    // global options are calculated only once for the measurement areas with id -1 and -2
+    bool _calcGlobalIFDOnly;
+    bool _calcProfileOnly;
+
+    // profile grid and averaging of the profiles over intervals of frames
+    float _gridSizeX;
+    float _gridSizeY;
+    int _profileRows;
+    int _profileColumns;
+    bool _profilePerFrame;
+    int _profileInterval;
+    bool _profileVariance;
+    int _profileOrigin; // first frame of the first interval
+    int _profileWindowIndex;
+    int _profileLastFrame; // last frame added to the current interval
+    ProfileWindow _densityWindow;
+    ProfileWindow _velocityWindow;
+    bool _failed; // an output file could not be written
+
+    /// reads the parameters of the measurement area and opens the output files
+    bool Init(const ConfigData_D & configData, int measurementAreaIndex, const PedData & pedData);
+    bool IsInFrameRange(int frid) const;
+    void CloseFiles();
     bool OpenFileMethodD(bool _isOneDimensional);
     bool OpenFileIndividualFD(bool _isOneDimensional, bool global);
 
     std::vector<std::pair<polygon_2d, int>> GetPolygons(
         const ConfigData_D & configData,
+        VoronoiDiagram & vd,
         std::vector<double> & XInFrame,
         std::vector<double> & YInFrame,
         std::vector<double> & VInFrame,
         std::vector<int> & IdInFrame);
     void OutputVoronoiResults(
-        const polygon_list & polygons,
+        const PolygonIndex & cells,
+        const std::string & frid,
+        const std::vector<double> & VInFrame,
+        std::string & output);
+    void WriteFrameOutput(int frid, const FrameOutput & output);
+    /// results of the measurement area for the Voronoi cells of a frame
+    void OutputFrameResults(
+        const PolygonIndex & cells,
         const std::string & frid,
-        const std::vector<double> & VInFrame);
+        const std::vector<double> & VInFrame,
+        const std::vector<int> & IdInFrame,
+        const std::vector<double> & XInFrame,
+        const std::vector<double> & YInFrame,
+        const std::vector<double> & ZInFrame,
+        FrameOutput & output);
     std::tuple<double, double> CalcDensityVelocity(
-        const polygon_list & polygons,
+        const PolygonIndex & cells,
         const std::vector<double> & VInFrame,
         const polygon_2d & measurementArea);
     void GetProfiles(
-        const ConfigData_D & configData,
         const std::string & frameId,
-        const polygon_list & polygons,
-        const std::vector<double> & velocity);
+        const PolygonIndex & cells,
+        const std::vector<double> & velocity,
+        FrameOutput & output);
+    /// adds the profiles of a frame to the current interval, a finished interval is written
+    void AddToProfileWindow(int frid, const FrameOutput & output);
+    /// writes the mean (and variance) of the profiles of the current interval
+    void WriteProfileWindow();
+    fs::path ProfilePath(
+        const std::string & quantity,
+        const std::string & prefix,
+        const std::string & frames) const;
+    /// false if the file cannot be created
+    bool WriteProfile(const fs::path & file, const std::vector<double> & values) const;
     void GetIndividualFD(
-        const polygon_list & polygon,
+        const PolygonIndex & cells,
         const std::vector<double> & Velocity,
         const std::vector<int> & Id,
         const polygon_2d & measureArea,
         const std::string & frid,
-        std::vector<double> & XInFrame,
-        std::vector<double> & YInFrame,
-        std::vector<double> & ZInFrame,
-        bool global);
+        const std::vector<double> & XInFrame,
+        const std::vector<double> & YInFrame,
+        const std::vector<double> & ZInFrame,
+        bool global,
+        std::string & output);
     /**
      * Reduce the precision of the points to two digits
      * @param polygon
      */
     void CalcVoronoiResults1D(
-        std::vector<double> & XInFrame,
-        std::vector<double> & VInFrame,
-        std::vector<int> & IdInFrame,
+        const std::vector<double> & XInFrame,
+        const std::vector<double> & VInFrame,
+        const std::vector<int> & IdInFrame,
         const polygon_2d & measureArea,
         const std::string & frid,
-        bool _calcIndividualFD);
+        bool _calcIndividualFD,
+        FrameOutput & output);
     void ReducePrecision(polygon_2d & polygon);
     double getOverlapRatio(
         const double & left,
@@ -18,8 +18,10 @@ Method_E::Method_E()
     _fps             = 16;
     _areaForMethod_E = nullptr;
     _lineForMethod_E = nullptr;
+    _crossings       = nullptr;
     _dx              = 0;
     _dy              = 0;
+    _writeDensity    = true;
 }
 
 bool Method_E::Process(const PedData & peddata, double zPos_measureArea)
@@ -31,8 +33,18 @@ bool Method_E::Process(const PedData & peddata, double zPos_measureArea)
     _yCor           = peddata.GetYCor();
     _minFrame       = peddata.GetMinFrame();
     _fps            = peddata.GetFps();
-    _firstFrame     = peddata.GetFirstFrame();
-    _passLine       = std::vector<bool>(peddata.GetNumPeds(), false);
+    // standing on the line in the first frame counts as passing it, otherwise the passing frame of
+    // these pedestrians would be shifted by one frame
+    const std::vector<int> passingFrames = _crossings->PassingFrames(
+        _lineForMethod_E->_id, peddata.GetNumPeds(), true, [&](int ped, int frame) {
+            return peddata.IsAtHeight(ped, frame, zPos_measureArea);
+        });
+    _passingPerFrame.assign(peddata.GetNumFrames(), 0);
+    for(int frame : passingFrames) {
+        if(frame >= 0) {
+            _passingPerFrame[frame]++;
+        }
+    }
     if(_deltaT == -1) {
         _deltaT = peddata.GetNumFrames() - 1;
     }
@@ -40,7 +52,7 @@ bool Method_E::Process(const PedData & peddata, double zPos_measureArea)
     if(_areaForMethod_E->_length < 0) {
         LOG_WARNING("The measurement area length for method E is not assigned! Cannot calculate "
                     "density and velocity!");
-        exit(EXIT_FAILURE);
+        return false;
     } else {
         _dx = _areaForMethod_E->_length;
         LOG_INFO("The measurement area length for method E is {:.3f}", _areaForMethod_E->_length);
@@ -50,7 +62,7 @@ bool Method_E::Process(const PedData & peddata, double zPos_measureArea)
         LOG_WARNING(
             "The measurement area length orthogonal to movement direction (delta y) for method E "
             "is not assigned! Cannot calculate density and velocity!");
-        exit(EXIT_FAILURE);
+        return false;
     } else {
         _dy = _areaForMethod_E->_lengthOrthogonal;
         LOG_INFO(
@@ -59,37 +71,44 @@ bool Method_E::Process(const PedData & peddata, double zPos_measureArea)
             _areaForMethod_E->_lengthOrthogonal);
     }
 
-    std::ofstream fRho =
-        GetFile("rho", "id_" + _measureAreaId, _outputLocation, _trajName, "Method_E");
     // density is the same regardless of line position -> only one file for all lines
+    std::ofstream fRho;
+    if(_writeDensity) {
+        fRho = GetFile("rho", "id_" + _measureAreaId, _outputLocation, _trajName, "Method_E");
+    }
     string idCombination = "id_" + _measureAreaId + "_line_" + _lineId;
     std::ofstream fFlow  = GetFile("flow", idCombination, _outputLocation, _trajName, "Method_E");
     std::ofstream fV     = GetFile("v", idCombination, _outputLocation, _trajName, "Method_E");
 
-    if(!(fRho.is_open() && fFlow.is_open() && fV.is_open())) {
+    if(!((fRho.is_open() || !_writeDensity) && fFlow.is_open() && fV.is_open())) {
         LOG_ERROR("Cannot open files to write data for method E!\n");
-        exit(EXIT_FAILURE);
+        return false;
     }
 
-    fRho << "#framerate:\t" << _fps << "\n\n#frame\tdensity(m ^ (-1))\tdensity(m ^ (-2))\n";
+    if(_writeDensity) {
+        fRho << "#framerate:\t" << _fps << "\n\n#frame\tdensity(m ^ (-1))\tdensity(m ^ (-2))\n";
+    }
     fFlow << "#flow rate(1/s)\tspecific flow rate(1/(ms))\n";
     fV << "#framerate:\t" << _fps << "\n\n#frame\taverage speed(m/s)\n";
 
     LOG_INFO("------------------------Analyzing with Method E-----------------------------");
 
     int accumPedsDeltaT = 0;
-    for(const auto & [frameNr, ids] : _peds_t) {
+    for(int frameNr = 0; frameNr < _peds_t.NumFrames(); frameNr++) {
+        IndexRange ids = _peds_t[frameNr];
+        if(ids.empty()) {
+            continue;
+        }
         int frid = frameNr + _minFrame;
         if((frid % 100) == 0) {
             LOG_INFO("frame ID = {}", frid);
         }
 
-        const vector<int> idsInFrame =
-            peddata.GetIndexInFrame(frameNr, _peds_t[frameNr], zPos_measureArea);
+        const vector<int> idsInFrame  = peddata.GetIndexInFrame(frameNr, ids, zPos_measureArea);
         const vector<double> XInFrame = peddata.GetXInFrame(frameNr, ids, zPos_measureArea);
         const vector<double> YInFrame = peddata.GetYInFrame(frameNr, ids, zPos_measureArea);
 
-        accumPedsDeltaT += GetNumberPassLine(frameNr, idsInFrame);
+        accumPedsDeltaT += _passingPerFrame[frameNr];
         OutputDensity(frameNr, idsInFrame.size(), XInFrame, YInFrame, fRho);
 
         if((frameNr % _deltaT) == 0 && frameNr != 0) {
@@ -100,14 +119,7 @@ bool Method_E::Process(const PedData & peddata, double zPos_measureArea)
             _densityPerFrame.clear();
             _densityPerFrame.push_back(overlappingDensity);
             accumPedsDeltaT = GetNumberOnLine(
-                frameNr,
-                idsInFrame,
-                _lineForMethod_E->_lineStartX,
-                _lineForMethod_E->_lineStartY,
-                _lineForMethod_E->_lineEndX,
-                _lineForMethod_E->_lineEndY,
-                _xCor,
-                _yCor);
+                frameNr, idsInFrame, _lineForMethod_E->_crossing, _xCor, _yCor);
 
             // because certain frames are used in two frame intervals (e.g. delta t = 10 -> 0 to 10,
             // 10 to 20 etc.) these overlapping values have to also be included for the following
@@ -122,45 +134,6 @@ bool Method_E::Process(const PedData & peddata, double zPos_measureArea)
     return true;
 }
 
-int Method_E::GetNumberPassLine(int frame, const vector<int> & ids)
-{
-    // returns number of pedestrians that passed the line during this frame
-    int framePassLine = 0;
-    for(auto const i : ids) {
-        bool IspassLine = false;
-        if(frame > _firstFrame[i] && !_passLine[i]) {
-            IspassLine = IsPassLine(
-                _lineForMethod_E->_lineStartX,
-                _lineForMethod_E->_lineStartY,
-                _lineForMethod_E->_lineEndX,
-                _lineForMethod_E->_lineEndY,
-                _xCor(i, frame - 1),
-                _yCor(i, frame - 1),
-                _xCor(i, frame),
-                _yCor(i, frame));
-        } else if(frame == _firstFrame[i] && !_passLine[i]) {
-            // If this is the first frame of this pedestrian and the pedestrain is exatly on the
-            // measurement line, the pedestrian is counted as having passed the line in this frame.
-            // Reason: If this were any other frame than the first frame, this frame would also be
-            // counted as the "passing frame". If the pedestrian would not be counted in this frame,
-            // it would be counted as having passed the line in the next frame -> this means that
-            // the "passing frame" would be shifted by one frame
-
-            point_2d lineP0(_lineForMethod_E->_lineStartX, _lineForMethod_E->_lineStartY);
-            point_2d lineP1(_lineForMethod_E->_lineEndX, _lineForMethod_E->_lineEndY);
-            segment line(lineP0, lineP1);
-            point_2d posPed(_xCor(i, frame), _yCor(i, frame));
-
-            IspassLine = boost::geometry::distance(posPed, line) < 0.1;
-        }
-        if(IspassLine) {
-            _passLine[i] = true;
-            framePassLine++;
-        }
-    }
-    return framePassLine;
-}
-
 void Method_E::OutputFlow(float fps, std::ofstream & fFlow, int accumPeds) const
 {
     double flow         = accumPeds / (_deltaT * 1.0 / fps);
@@ -187,20 +160,20 @@ void Method_E::OutputDensity(
     const vector<double> & ys,
     std::ofstream & fRho)
 {
-    int pedsInMA = 0;
-    for(int i = 0; i < numPeds; i++) {
-        // N(t0, delta x) can be detected in a purely geometric way, tIn/tOut does not make sense
-        // here
-        if(covered_by(make<point_2d>(xs[i], ys[i]), _areaForMethod_E->_poly)) {
-            pedsInMA++;
-        }
-    }
+    // N(t0, delta x) can be detected in a purely geometric way, tIn/tOut does not make sense
+    // here
+    thread_local std::vector<std::uint8_t> inside;
+    inside.resize(numPeds);
+    _areaForMethod_E->_predicate.CoveredBy(xs.data(), ys.data(), numPeds, inside.data());
+    const int pedsInMA = std::count(inside.begin(), inside.end(), 1);
 
     double density       = pedsInMA / _dx;
     double densityDeltaY = pedsInMA / (_dx * _dy);
     _densityPerFrame.push_back(densityDeltaY);
 
-    fRho << frmNr << "\t" << density << "\t" << densityDeltaY << "\n";
+    if(_writeDensity) {
+        fRho << frmNr << "\t" << density << "\t" << densityDeltaY << "\n";
+    }
 }
 
 void Method_E::SetMeasurementArea(MeasurementArea_B * area)
@@ -219,3 +192,13 @@ void Method_E::SetTimeInterval(int deltaT)
 {
     _deltaT = deltaT;
 }
+
+void Method_E::SetCrossingIndex(const CrossingIndex * crossings)
+{
+    _crossings = crossings;
+}
+
+void Method_E::SetWriteDensity(bool writeDensity)
+{
+    _writeDensity = writeDensity;
+}
@@ -2,13 +2,11 @@
 #define METHOD_E_H_
 
 #include "../general/Macros.h"
+#include "CrossingIndex.h"
 #include "MeasurementArea.h"
 #include "PedData.h"
 #include "tinyxml.h"
 
-#include <boost/numeric/ublas/io.hpp>
-#include <boost/numeric/ublas/matrix.hpp>
-
 typedef boost::geometry::model::segment<boost::geometry::model::d2::point_xy<double>> segment;
 
 class Method_E
@@ -20,16 +18,18 @@ public:
     void SetMeasurementArea(MeasurementArea_B * area);
     void SetLine(MeasurementArea_L * area);
     void SetTimeInterval(int deltaT);
+    void SetCrossingIndex(const CrossingIndex * crossings);
+    /// whether the density file of the measurement area is written, it is shared by all lines
+    void SetWriteDensity(bool writeDensity);
     bool Process(const PedData & peddata, double zPos_measureArea);
 
 private:
     fs::path _trajName;
     fs::path _outputLocation;
 
-    std::map<int, std::vector<int>> _peds_t;
-    ub::matrix<double> _xCor;
-    ub::matrix<double> _yCor;
-    std::vector<int> _firstFrame;
+    FrameIndexView _peds_t;
+    TrajectoryView<double> _xCor;
+    TrajectoryView<double> _yCor;
     int _minFrame;
     float _fps;
 
@@ -37,12 +37,15 @@ private:
     std::string _lineId;
     MeasurementArea_B * _areaForMethod_E;
     MeasurementArea_L * _lineForMethod_E;
+    const CrossingIndex * _crossings;
 
-    std::vector<bool> _passLine; // which pedestrians have passed the line
+    // number of pedestrians passing the line for the first time in each frame
+    std::vector<int> _passingPerFrame;
     int _deltaT;
     double _dx;
     double _dy;
     std::vector<double> _densityPerFrame;
+    bool _writeDensity;
 
     void OutputFlow(float fps, std::ofstream & fFlow, int accumPeds) const;
 
@@ -54,14 +57,6 @@ private:
         const std::vector<double> & xs,
         const std::vector<double> & ys,
         std::ofstream & fRho);
-
-    /**
-     * returns number of pedestrians that passed the line during this frame
-     * @param frame current frame
-     * @param ids of pedestrians to check
-     * @return number of pedestrians that passed the line during this frame
-     */
-    int GetNumberPassLine(int frame, const std::vector<int> & ids);
 };
 
 #endif /* METHOD_E_H_ */
@@ -3,6 +3,7 @@
 #include "../Analysis.h"
 #include "../general/Logger.h"
 #include "../general/MethodFunctions.h"
+#include "EntryExitIndex.h"
 
 #include <fstream>
 #include <iostream>
@@ -17,11 +18,13 @@ Method_F::Method_F()
     _fps             = 16;
     _areaForMethod_F = nullptr;
     _lineForMethod_F = nullptr;
+    _crossings       = nullptr;
     _numPeds         = 0;
     _numFrames       = 0;
     _dx              = 0;
     _dy              = 0;
     _averageV        = std::numeric_limits<double>::quiet_NaN();
+    _writeVelocity   = true;
 }
 
 bool Method_F::Process(const PedData & peddata, double zPos_measureArea)
@@ -34,8 +37,18 @@ bool Method_F::Process(const PedData & peddata, double zPos_measureArea)
     _xCor           = peddata.GetXCor();
     _yCor           = peddata.GetYCor();
     _fps            = peddata.GetFps();
-    _firstFrame     = peddata.GetFirstFrame();
-    _passLine       = std::vector<bool>(_numPeds, false);
+    // standing on the line in the first frame counts as passing it, otherwise the passing frame of
+    // these pedestrians would be shifted by one frame
+    const std::vector<int> passingFrames = _crossings->PassingFrames(
+        _lineForMethod_F->_id, _numPeds, true, [&](int ped, int frame) {
+            return peddata.IsAtHeight(ped, frame, zPos_measureArea);
+        });
+    _passingPerFrame.assign(peddata.GetNumFrames(), 0);
+    for(int frame : passingFrames) {
+        if(frame >= 0) {
+            _passingPerFrame[frame]++;
+        }
+    }
     if(_deltaT == -1) {
         _deltaT = _numFrames - 1;
     }
@@ -45,7 +58,7 @@ bool Method_F::Process(const PedData & peddata, double zPos_measureArea)
     if(_areaForMethod_F->_length < 0) {
         LOG_WARNING("The measurement area length for method F is not assigned! Cannot calculate "
                     "density and velocity!");
-        exit(EXIT_FAILURE);
+        return false;
     } else {
         _dx = _areaForMethod_F->_length;
         LOG_INFO("The measurement area length for method F is {:.3f}", _areaForMethod_F->_length);
@@ -55,7 +68,7 @@ bool Method_F::Process(const PedData & peddata, double zPos_measureArea)
         LOG_WARNING(
             "The measurement area length orthogonal to movement direction (delta y) for method F "
             "is not assigned! Cannot calculate density and velocity!");
-        exit(EXIT_FAILURE);
+        return false;
     } else {
         _dy = _areaForMethod_F->_lengthOrthogonal;
         LOG_INFO(
@@ -64,32 +77,37 @@ bool Method_F::Process(const PedData & peddata, double zPos_measureArea)
             _areaForMethod_F->_lengthOrthogonal);
     }
 
-    vector<vector<int>> TinTout = GetTinTout(
-        peddata.GetNumFrames(), _areaForMethod_F->_poly, _numPeds, _peds_t, _xCor, _yCor);
-    _tIn  = TinTout[0];
-    _tOut = TinTout[1];
-    OutputVelocity(peddata);
+    const EntryExitIndex entryExit(
+        {&_areaForMethod_F->_predicate}, EntryExitRule::CoveredByWithin, _xCor, _yCor);
+    EntryExitTimes times = entryExit.GetTinTout(0, peddata.GetNumFrames());
+    _tIn                 = std::move(times.tIn);
+    _tOut                = std::move(times.tOut);
+    if(!OutputVelocity(peddata)) {
+        return false;
+    }
     if(!isnan(_averageV)) {
-        OutputDensityLine(peddata, zPos_measureArea);
+        return OutputDensityLine(peddata, zPos_measureArea);
     }
 
     return true;
 }
 
-void Method_F::OutputVelocity(const PedData & peddata)
+bool Method_F::OutputVelocity(const PedData & peddata)
 {
     string idCombination = "id_" + _measureAreaId;
     // does not have to include line id because this file is only specific to the measurement area
-    std::ofstream fV = GetFile("v", idCombination, _outputLocation, _trajName, "Method_F");
-    if(!fV.is_open()) {
-        LOG_ERROR("Cannot open file to write velocity data for method F!\n");
-        exit(EXIT_FAILURE);
+    std::ofstream fV;
+    if(_writeVelocity) {
+        fV = GetFile("v", idCombination, _outputLocation, _trajName, "Method_F");
+        if(!fV.is_open()) {
+            LOG_ERROR("Cannot open file to write velocity data for method F!\n");
+            return false;
+        }
+        fV << "#person index\tvelocity_i(m /s)\n";
     }
 
-
     double sumV    = 0;
     int numberPeds = 0;
-    fV << "#person index\tvelocity_i(m /s)\n";
     for(int i = 0; i < _numPeds; i++) {
         if(_tOut[i] != 0) {
             if(_tIn[i] == 0) {
@@ -102,7 +120,7 @@ void Method_F::OutputVelocity(const PedData & peddata)
 
                 double predictedX = 2 * _xCor(i, 0) - _xCor(i, 1);
                 double predictedY = 2 * _yCor(i, 0) - _yCor(i, 1);
-                if(covered_by(make<point_2d>(predictedX, predictedY), _areaForMethod_F->_poly)) {
+                if(_areaForMethod_F->_predicate.CoveredBy(predictedX, predictedY)) {
                     // this condition has to be adjusted if another variant is used for tIn/tOut!
                     // here variant 4 is used
                     continue;
@@ -114,7 +132,9 @@ void Method_F::OutputVelocity(const PedData & peddata)
                 double velocity = _dx / ((_tOut[i] - _tIn[i] * 1.0) / _fps);
                 sumV += velocity;
                 numberPeds++;
-                fV << peddata.GetId(_tOut[i], i) << "\t" << velocity << "\n";
+                if(_writeVelocity) {
+                    fV << peddata.GetId(_tOut[i], i) << "\t" << velocity << "\n";
+                }
             }
         }
         // should the pedestrians that do not pass the measurement area also be added to the output
@@ -126,24 +146,28 @@ void Method_F::OutputVelocity(const PedData & peddata)
         _averageV = sumV / numberPeds;
     }
     fV.close();
+    return true;
 }
 
-void Method_F::OutputDensityLine(const PedData & peddata, const double & zPos_measureArea)
+bool Method_F::OutputDensityLine(const PedData & peddata, const double & zPos_measureArea)
 {
     string idCombination = "id_" + _measureAreaId + "_line_" + _lineId;
     std::ofstream fRho = GetFile("rho_flow", idCombination, _outputLocation, _trajName, "Method_F");
     if(!fRho.is_open()) {
         LOG_ERROR("Cannot open file to write density and flow data for method F!\n");
-        exit(EXIT_FAILURE);
+        return false;
     }
 
     int accumPedsDeltaT = 0;
     fRho << "#number pedestrians\tdensity(m^(-2))\tflow rate(1/s)\tspecific flow rate(1/(ms))\n";
     // should the number of pedestrians be removed from output?
-    for(const auto & [frameNr, ids] : _peds_t) {
-        vector<int> idsInFrame =
-            peddata.GetIndexInFrame(frameNr, _peds_t[frameNr], zPos_measureArea);
-        accumPedsDeltaT += GetNumberPassLine(frameNr, idsInFrame);
+    for(int frameNr = 0; frameNr < _peds_t.NumFrames(); frameNr++) {
+        IndexRange ids = _peds_t[frameNr];
+        if(ids.empty()) {
+            continue;
+        }
+        vector<int> idsInFrame = peddata.GetIndexInFrame(frameNr, ids, zPos_measureArea);
+        accumPedsDeltaT += _passingPerFrame[frameNr];
 
         if((frameNr % _deltaT) == 0 && frameNr != 0) {
             double density      = accumPedsDeltaT / ((_deltaT / _fps) * _dy) * (1 / _averageV);
@@ -153,14 +177,7 @@ void Method_F::OutputDensityLine(const PedData & peddata, const double & zPos_me
                  << "\n";
 
             accumPedsDeltaT = GetNumberOnLine(
-                frameNr,
-                idsInFrame,
-                _lineForMethod_F->_lineStartX,
-                _lineForMethod_F->_lineStartY,
-                _lineForMethod_F->_lineEndX,
-                _lineForMethod_F->_lineEndY,
-                _xCor,
-                _yCor);
+                frameNr, idsInFrame, _lineForMethod_F->_crossing, _xCor, _yCor);
             // because certain frames are used in two frame intervals (e.g. delta t = 10 -> 0 to 10,
             // 10 to 20 etc.) these overlapping values have to also be included for the following
             // time interval
@@ -171,45 +188,7 @@ void Method_F::OutputDensityLine(const PedData & peddata, const double & zPos_me
         }
     }
     fRho.close();
-}
-
-int Method_F::GetNumberPassLine(int frame, const vector<int> & ids)
-{
-    // returns number of pedestrians that passed the line during this frame
-    int framePassLine = 0;
-    for(auto const i : ids) {
-        bool IspassLine = false;
-        if(frame > _firstFrame[i] && !_passLine[i]) {
-            IspassLine = IsPassLine(
-                _lineForMethod_F->_lineStartX,
-                _lineForMethod_F->_lineStartY,
-                _lineForMethod_F->_lineEndX,
-                _lineForMethod_F->_lineEndY,
-                _xCor(i, frame - 1),
-                _yCor(i, frame - 1),
-                _xCor(i, frame),
-                _yCor(i, frame));
-        } else if(frame == _firstFrame[i] && !_passLine[i]) {
-            // If this is the first frame of this pedestrian and the pedestrain is exatly on the
-            // measurement line, the pedestrian is counted as having passed the line in this frame.
-            // Reason: If this were any other frame than the first frame, this frame would also be
-            // counted as the "passing frame". If the pedestrian would not be counted in this frame,
-            // it would be counted as having passed the line in the next frame -> this means that
-            // the "passing frame" would be shifted by one frame
-
-            point_2d lineP0(_lineForMethod_F->_lineStartX, _lineForMethod_F->_lineStartY);
-            point_2d lineP1(_lineForMethod_F->_lineEndX, _lineForMethod_F->_lineEndY);
-            segment line(lineP0, lineP1);
-            point_2d posPed(_xCor(i, frame), _yCor(i, frame));
-
-            IspassLine = boost::geometry::distance(posPed, line) < 0.1;
-        }
-        if(IspassLine) {
-            _passLine[i] = true;
-            framePassLine++;
-        }
-    }
-    return framePassLine;
+    return true;
 }
 
 void Method_F::SetMeasurementArea(MeasurementArea_B * area)
@@ -228,3 +207,13 @@ void Method_F::SetTimeInterval(int deltaT)
 {
     _deltaT = deltaT;
 }
+
+void Method_F::SetCrossingIndex(const CrossingIndex * crossings)
+{
+    _crossings = crossings;
+}
+
+void Method_F::SetWriteVelocity(bool writeVelocity)
+{
+    _writeVelocity = writeVelocity;
+}
@@ -2,13 +2,11 @@
 #define METHOD_F_H_
 
 #include "../general/Macros.h"
+#include "CrossingIndex.h"
 #include "MeasurementArea.h"
 #include "PedData.h"
 #include "tinyxml.h"
 
-#include <boost/numeric/ublas/io.hpp>
-#include <boost/numeric/ublas/matrix.hpp>
-
 typedef boost::geometry::model::segment<boost::geometry::model::d2::point_xy<double>> segment;
 
 class Method_F
@@ -20,16 +18,18 @@ public:
     void SetMeasurementArea(MeasurementArea_B * area);
     void SetLine(MeasurementArea_L * area);
     void SetTimeInterval(int deltaT);
+    void SetCrossingIndex(const CrossingIndex * crossings);
+    /// whether the velocity file of the measurement area is written, it is shared by all lines
+    void SetWriteVelocity(bool writeVelocity);
     bool Process(const PedData & peddata, double zPos_measureArea);
 
 private:
     fs::path _trajName;
     fs::path _outputLocation;
 
-    std::map<int, std::vector<int>> _peds_t;
-    ub::matrix<double> _xCor;
-    ub::matrix<double> _yCor;
-    std::vector<int> _firstFrame;
+    FrameIndexView _peds_t;
+    TrajectoryView<double> _xCor;
+    TrajectoryView<double> _yCor;
     int _numPeds;
     int _numFrames;
     float _fps;
@@ -38,6 +38,7 @@ private:
     std::string _lineId;
     MeasurementArea_B * _areaForMethod_F;
     MeasurementArea_L * _lineForMethod_F;
+    const CrossingIndex * _crossings;
     int _deltaT;
     double _dx;
     double _dy;
@@ -45,19 +46,13 @@ private:
     std::vector<int> _tIn;       // the time at which each pedestrian enters the measurement area
     std::vector<int> _tOut;      // the time at which each pedestrian exits the measurement area
     double _averageV;
-    std::vector<bool> _passLine; // which pedestrians have passed the line
-
-    void OutputVelocity(const PedData & peddata);
+    // number of pedestrians passing the line for the first time in each frame
+    std::vector<int> _passingPerFrame;
+    bool _writeVelocity;
 
-    void OutputDensityLine(const PedData & peddata, const double & zPos_measureArea);
+    bool OutputVelocity(const PedData & peddata);
 
-    /**
-     * returns number of pedestrians that passed the line during this frame
-     * @param frame current frame
-     * @param ids of pedestrians to check
-     * @return number of pedestrians that passed the line during this frame
-     */
-    int GetNumberPassLine(int frame, const std::vector<int> & ids);
+    bool OutputDensityLine(const PedData & peddata, const double & zPos_measureArea);
 };
 
 #endif /* METHOD_F_H_ */
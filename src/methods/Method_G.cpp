@@ -3,6 +3,7 @@
 #include "../Analysis.h"
 #include "../general/Logger.h"
 #include "../general/MethodFunctions.h"
+#include "EntryExitIndex.h"
 
 #include <fstream>
 #include <iostream>
@@ -52,7 +53,7 @@ bool Method_G::Process(const PedData & peddata)
 
     if(!(fRhoDx.is_open() && fVdx.is_open() && fCoordDx.is_open())) {
         LOG_ERROR("Cannot open files to write data method G (fixed area)!\n");
-        exit(EXIT_FAILURE);
+        return false;
     }
     fRhoDx << "#density(m^(-1))\n";
     fVdx << "#harmonic mean velocity(m/s)\n";
@@ -63,21 +64,31 @@ bool Method_G::Process(const PedData & peddata)
     if(_areaForMethod_G->_length < 0) {
         LOG_WARNING("The measurement area length for method G is not assigned! Cannot calculate "
                     "density and velocity!");
-        exit(EXIT_FAILURE);
+        return false;
     } else {
         _deltaX = _areaForMethod_G->_length;
         LOG_INFO("The measurement area length for method G is {:.3f}", _areaForMethod_G->_length);
     }
 
     LOG_INFO("Analyzing dx values (fixed place)");
-    polygon_list cutPolygons = GetCutPolygons();
-    for(polygon_2d polygon : cutPolygons) {
-        vector<vector<int>> TinTout =
-            GetTinTout(_numFrames, polygon, _numPeds, _peds_t, _xCor, _yCor);
-        // Is this the most efficient way to iterate through all
-        // frames, pedestrians and cut measurement areas?
+    polygon_list cutPolygons;
+    if(!GetCutPolygons(cutPolygons)) {
+        return false;
+    }
+    // the entries and exits of all cut polygons and of the measurement area are found in one sweep
+    // over the trajectories, the measurement area is the last one
+    vector<AreaPredicate> cutAreas(cutPolygons.begin(), cutPolygons.end());
+    vector<const AreaPredicate *> areas;
+    for(const AreaPredicate & cutArea : cutAreas) {
+        areas.push_back(&cutArea);
+    }
+    areas.push_back(&_areaForMethod_G->_predicate);
+    const EntryExitIndex entryExit(areas, EntryExitRule::CoveredByWithin, _xCor, _yCor);
 
-        OutputDensityVdx(_numFrames, TinTout[0], TinTout[1], fRhoDx, fVdx, polygon);
+    for(std::size_t i = 0; i < cutPolygons.size(); i++) {
+        const polygon_2d & polygon = cutPolygons[i];
+        const EntryExitTimes times = entryExit.GetTinTout(i, _numFrames);
+        OutputDensityVdx(_numFrames, times.tIn, times.tOut, fRhoDx, fVdx, cutAreas[i]);
 
         ring allPoints = polygon.outer();
         allPoints.pop_back();
@@ -96,26 +107,29 @@ bool Method_G::Process(const PedData & peddata)
     fVdx.close();
 
     LOG_INFO("Analyzing dt values (fixed time)");
-    OutputDensityVFlowDt(_numFrames - ((_numFrames - 1) % _deltaT));
-
-    return true;
+    const int numFramesDt = _numFrames - ((_numFrames - 1) % _deltaT);
+    return OutputDensityVFlowDt(
+        numFramesDt,
+        peddata.GetCumulativeDistance(),
+        entryExit.GetTinTout(cutPolygons.size(), numFramesDt));
 }
 
-void Method_G::OutputDensityVFlowDt(int numFrames)
+bool Method_G::OutputDensityVFlowDt(
+    int numFrames,
+    const CumulativeDistance & distance,
+    const EntryExitTimes & times)
 {
     std::ofstream fRhoVFlow =
         GetFile("rho_flow_v", "id_" + _measureAreaId, _outputLocation, _trajName, "Method_G");
 
     if(!fRhoVFlow.is_open()) {
         LOG_ERROR("Cannot open files to write data method G (fixed time)!\n");
-        exit(EXIT_FAILURE);
+        return false;
     }
     fRhoVFlow << "#harmonic mean velocity(m/s)\tdensity(m ^ (-1))\tflow rate(1/s)\n";
 
-    vector<vector<int>> TinTout =
-        GetTinTout(numFrames, _areaForMethod_G->_poly, _numPeds, _peds_t, _xCor, _yCor);
-    vector<int> tIn  = TinTout[0];
-    vector<int> tOut = TinTout[1];
+    const vector<int> & tIn  = times.tIn;
+    const vector<int> & tOut = times.tOut;
 
     for(int i = 0; i < (numFrames - _dt); i += _dt) {
         // <= does not work here, needs to be <
@@ -131,19 +145,19 @@ void Method_G::OutputDensityVFlowDt(int numFrames)
             switch(entryExit) {
                 case EntryExit::EntryAndExit:
                     pedsInMeasureArea++;
-                    sumDistance += GetExactDistance(j, tIn[j], tOut[j], _xCor, _yCor);
+                    sumDistance += GetExactDistance(j, tIn[j], tOut[j], distance);
                     break;
                 case EntryExit::NoEntryNorExit:
                     pedsInMeasureArea++;
-                    sumDistance += GetExactDistance(j, i, i + _dt, _xCor, _yCor);
+                    sumDistance += GetExactDistance(j, i, i + _dt, distance);
                     break;
                 case EntryExit::OnlyExit:
                     pedsInMeasureArea++;
-                    sumDistance += GetExactDistance(j, i, tOut[j], _xCor, _yCor);
+                    sumDistance += GetExactDistance(j, i, tOut[j], distance);
                     break;
                 case EntryExit::OnlyEntry:
                     pedsInMeasureArea++;
-                    sumDistance += GetExactDistance(j, tIn[j], i + _dt, _xCor, _yCor);
+                    sumDistance += GetExactDistance(j, tIn[j], i + _dt, distance);
                     break;
                 case EntryExit::NotInArea:
                     break;
@@ -156,9 +170,10 @@ void Method_G::OutputDensityVFlowDt(int numFrames)
         fRhoVFlow << meanVelocity << "\t" << density << "\t" << flow << "\n";
     }
     fRhoVFlow.close();
+    return true;
 }
 
-polygon_list Method_G::GetCutPolygons()
+bool Method_G::GetCutPolygons(polygon_list & cutPolygons)
 {
     /*
        These parameters are given by the ini-file
@@ -186,7 +201,7 @@ polygon_list Method_G::GetCutPolygons()
         // this does not check whether its a rectangle
         // only checks the number of boundary points
         LOG_WARNING("The measurement area length for method G is not a rectangle!");
-        exit(EXIT_FAILURE);
+        return false;
     }
     for(int i = 0; i < 4; i++) {
         // find the index of the given points to find point C
@@ -220,7 +235,7 @@ polygon_list Method_G::GetCutPolygons()
     }
     if(posPointD == -1 || posPointA == -1) {
         LOG_WARNING("The given points for method G are not valid!");
-        exit(EXIT_FAILURE);
+        return false;
     }
 
     _dx    = distance(allPoints[posPointA], allPoints[posPointD]) / _n * CMtoM;
@@ -231,7 +246,6 @@ polygon_list Method_G::GetCutPolygons()
     int c1 = allPoints[posPointC].x();
     int c2 = allPoints[posPointC].y();
 
-    polygon_list cutPolygons;
     for(double k = 0; k < _n; k++) {
         polygon_2d polygon;
         {
@@ -250,16 +264,16 @@ polygon_list Method_G::GetCutPolygons()
         correct(polygon);
         cutPolygons.push_back(polygon);
     }
-    return cutPolygons;
+    return true;
 }
 
 void Method_G::OutputDensityVdx(
     int numFrames,
-    vector<int> tIn,
-    vector<int> tOut,
+    const vector<int> & tIn,
+    const vector<int> & tOut,
     std::ofstream & fRho,
     std::ofstream & fV,
-    const polygon_2d & polygon)
+    const AreaPredicate & area)
 {
     for(int i = 0; i < (numFrames - _deltaT); i += _deltaT) {
         int pedsInMeasureArea = 0;
@@ -279,7 +293,7 @@ void Method_G::OutputDensityVdx(
 
                     double predictedX = 2 * _xCor(j, 0) - _xCor(j, 1);
                     double predictedY = 2 * _yCor(j, 0) - _yCor(j, 1);
-                    if(covered_by(make<point_2d>(predictedX, predictedY), polygon)) {
+                    if(area.CoveredBy(predictedX, predictedY)) {
                         // this condition has to be adjusted if another variant is used for
                         // tIn/tOut! here variant 4 is used
                         continue;
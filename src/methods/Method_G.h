@@ -2,13 +2,11 @@
 #define METHOD_G_H_
 
 #include "../general/Macros.h"
+#include "EntryExitIndex.h"
 #include "MeasurementArea.h"
 #include "PedData.h"
 #include "tinyxml.h"
 
-#include <boost/numeric/ublas/io.hpp>
-#include <boost/numeric/ublas/matrix.hpp>
-
 typedef boost::geometry::model::segment<boost::geometry::model::d2::point_xy<double>> segment;
 
 class Method_G
@@ -30,10 +28,10 @@ private:
     fs::path _scriptsLocation;
     fs::path _outputLocation;
 
-    std::map<int, std::vector<int>> _peds_t;
-    ub::matrix<double> _xCor;
-    ub::matrix<double> _yCor;
-    std::vector<int> _firstFrame;
+    FrameIndexView _peds_t;
+    TrajectoryView<double> _xCor;
+    TrajectoryView<double> _yCor;
+    ConstSpan<int> _firstFrame;
     int _minFrame;
     int _numPeds;
     float _fps;
@@ -51,19 +49,23 @@ private:
 
     void OutputDensityVdx(
         int numFrames,
-        std::vector<int> tIn,
-        std::vector<int> tOut,
+        const std::vector<int> & tIn,
+        const std::vector<int> & tOut,
         std::ofstream & fRho,
         std::ofstream & fV,
-        const polygon_2d & polygon);
+        const AreaPredicate & area);
 
-    void OutputDensityVFlowDt(int numFrames);
+    bool OutputDensityVFlowDt(
+        int numFrames,
+        const CumulativeDistance & distance,
+        const EntryExitTimes & times);
 
     /**
-     * returns a list of the cut polygons using the paramters given in the inifile
-     * @return list of the cut polygons using the paramters given in the inifile
+     * calculates the cut polygons using the paramters given in the inifile
+     * @param cutPolygons list to which the cut polygons are added
+     * @return false if the measurement area or the points given in the inifile are not valid
      */
-    polygon_list GetCutPolygons();
+    bool GetCutPolygons(polygon_list & cutPolygons);
 };
 
 #endif /* METHOD_G_H_ */
@@ -3,6 +3,7 @@
 #include "../Analysis.h"
 #include "../general/Logger.h"
 #include "../general/MethodFunctions.h"
+#include "EntryExitIndex.h"
 
 #include <fstream>
 #include <iostream>
@@ -46,7 +47,7 @@ bool Method_H::Process(const PedData & peddata)
         GetFile("flow_rho_v", "id_" + _measureAreaId, _outputLocation, _trajName, "Method_H");
     if(!fRhoVFlow.is_open()) {
         LOG_ERROR("Cannot open file to write density, flow and velocity data for method H!\n");
-        exit(EXIT_FAILURE);
+        return false;
     }
     fRhoVFlow << "#mean flow (1 / s)\tmean density (1 / m)\tmean velocity (m / s)\n";
 
@@ -56,12 +57,12 @@ bool Method_H::Process(const PedData & peddata)
     if(_areaForMethod_H->_length < 0) {
         LOG_WARNING("The measurement area length for method H is not assigned! Cannot calculate "
                     "mean density, velocity and flow!");
-        exit(EXIT_FAILURE);
+        return false;
     } else {
         _dx = _areaForMethod_H->_length;
         LOG_INFO("The measurement area length for method H is {:.3f}", _areaForMethod_H->_length);
     }
-    OutputRhoVFlow(peddata.GetNumFrames(), fRhoVFlow);
+    OutputRhoVFlow(peddata.GetNumFrames(), peddata.GetCumulativeDistance(), fRhoVFlow);
     fRhoVFlow.close();
 
     return true;
@@ -69,45 +70,19 @@ bool Method_H::Process(const PedData & peddata)
 
 void Method_H::GetTinToutEntExt(int numFrames)
 {
-    vector<bool> IsinMeasurezone(_numPeds, false);
-
-    for(int frameNr = 0; frameNr < numFrames; frameNr++) {
-        vector<int> ids = _peds_t[frameNr];
-        for(int ID : ids) {
-            int x = _xCor(ID, frameNr);
-            int y = _yCor(ID, frameNr);
-
-            // this is variant 4
-            if(covered_by(make<point_2d>(x, y), _areaForMethod_H->_poly) &&
-               !(IsinMeasurezone[ID])) {
-                _tIn[ID]            = frameNr;
-                IsinMeasurezone[ID] = true;
-                _entrancePoint[ID].x(x * CMtoM);
-                _entrancePoint[ID].y(y * CMtoM);
-            } else if(
-                (!within(make<point_2d>(x, y), _areaForMethod_H->_poly)) && IsinMeasurezone[ID]) {
-                if(_tIn[ID] == 0 && frameNr == 1) {
-                    if(!within(
-                           make<point_2d>(_xCor(ID, 0), _yCor(ID, 0)), _areaForMethod_H->_poly)) {
-                        // edge case -> if first frame in general is exactly on the upper
-                        // boundary of MA, this is not the entrance frame, but the exit frame
-                        _tOut[ID] = 0;
-                        _exitPoint[ID].x(_xCor(ID, 0) * CMtoM);
-                        _exitPoint[ID].y(_yCor(ID, 0) * CMtoM);
-                        IsinMeasurezone[ID] = false;
-                        continue;
-                    }
-                }
-                _tOut[ID]           = frameNr;
-                IsinMeasurezone[ID] = false;
-                _exitPoint[ID].x(x * CMtoM);
-                _exitPoint[ID].y(y * CMtoM);
-            }
-        }
-    }
+    const EntryExitIndex entryExit(
+        {&_areaForMethod_H->_predicate}, EntryExitRule::CoveredByWithin, _xCor, _yCor);
+    EntryExitTimes times = entryExit.GetTinTout(0, numFrames);
+    _tIn                 = std::move(times.tIn);
+    _tOut                = std::move(times.tOut);
+    _entrancePoint       = std::move(times.entrancePoint);
+    _exitPoint           = std::move(times.exitPoint);
 }
 
-void Method_H::OutputRhoVFlow(int numFrames, std::ofstream & fRhoVFlow)
+void Method_H::OutputRhoVFlow(
+    int numFrames,
+    const CumulativeDistance & distance,
+    std::ofstream & fRhoVFlow)
 {
     for(int i = 0; i < (numFrames - _deltaT); i += _deltaT) {
         double sumTime     = 0;
@@ -121,19 +96,19 @@ void Method_H::OutputRhoVFlow(int numFrames, std::ofstream & fRhoVFlow)
             switch(entryExit) {
                 case EntryExit::EntryAndExit:
                     sumTime += (_tOut[j] - _tIn[j] * 1.0) / _fps;
-                    sumDistance += GetExactDistance(j, _tIn[j], _tOut[j], _xCor, _yCor);
+                    sumDistance += GetExactDistance(j, _tIn[j], _tOut[j], distance);
                     break;
                 case EntryExit::NoEntryNorExit:
                     sumTime += (_deltaT * 1.0) / _fps;
-                    sumDistance += GetExactDistance(j, i, i + _deltaT, _xCor, _yCor);
+                    sumDistance += GetExactDistance(j, i, i + _deltaT, distance);
                     break;
                 case EntryExit::OnlyExit:
                     sumTime += (_tOut[j] - i * 1.0) / _fps;
-                    sumDistance += GetExactDistance(j, i, _tOut[j], _xCor, _yCor);
+                    sumDistance += GetExactDistance(j, i, _tOut[j], distance);
                     break;
                 case EntryExit::OnlyEntry:
                     sumTime += (i + _deltaT - _tIn[j] * 1.0) / _fps;
-                    sumDistance += GetExactDistance(j, _tIn[j], i + _deltaT, _xCor, _yCor);
+                    sumDistance += GetExactDistance(j, _tIn[j], i + _deltaT, distance);
                     break;
                 case EntryExit::NotInArea:
                     break;
@@ -6,9 +6,6 @@
 #include "PedData.h"
 #include "tinyxml.h"
 
-#include <boost/numeric/ublas/io.hpp>
-#include <boost/numeric/ublas/matrix.hpp>
-
 typedef boost::geometry::model::segment<boost::geometry::model::d2::point_xy<double>> segment;
 
 class Method_H
@@ -27,10 +24,10 @@ private:
     fs::path _scriptsLocation;
     fs::path _outputLocation;
 
-    std::map<int, std::vector<int>> _peds_t;
-    ub::matrix<double> _xCor;
-    ub::matrix<double> _yCor;
-    std::vector<int> _firstFrame;
+    FrameIndexView _peds_t;
+    TrajectoryView<double> _xCor;
+    TrajectoryView<double> _yCor;
+    ConstSpan<int> _firstFrame;
     int _minFrame;
     int _numPeds;
     float _fps;
@@ -51,7 +48,10 @@ private:
      */
     void GetTinToutEntExt(int numFrames);
 
-    void OutputRhoVFlow(int numFrames, std::ofstream & fRhoVFlow);
+    void OutputRhoVFlow(
+        int numFrames,
+        const CumulativeDistance & distance,
+        std::ofstream & fRhoVFlow);
 };
 
 #endif /* METHOD_H_H_ */
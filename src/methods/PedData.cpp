@@ -29,13 +29,33 @@
 #include "PedData.h"
 
 #include "../general/Logger.h"
+#include "../general/MappedFile.h"
 
+#include <charconv>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fmt/format.h>
 #include <fstream>
+#include <iterator>
+#include <random>
 #include <string>
-#include <unordered_set>
+#include <string_view>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#endif
 
-using std::ifstream;
 using std::map;
 using std::string;
 using std::vector;
@@ -59,6 +79,8 @@ bool PedData::ReadData(
     _deltaF                 = deltaF;
     _vComponent             = vComponent;
     _IgnoreBackwardMovement = IgnoreBackwardMovement;
+    _velocity               = TrajectoryMatrix<double>();
+    _velocityValid          = false;
     _projectRootDir         = projectRootDir;
     _outputLocation         = outputLocation;
     _trajName               = filename;
@@ -73,258 +95,755 @@ bool PedData::ReadData(
     }
 
     else if(trajformat == FORMAT_PLAIN) {
-        result = InitializeVariables(fullTrajectoriesPathName);
+        // the velocity direction column of the file is not part of the cache
+        const bool useCache = _vComponent != "F";
+        if(!(useCache && ReadBinaryCache(fullTrajectoriesPathName))) {
+            result = InitializeVariables(fullTrajectoriesPathName);
+            if(result && useCache) {
+                WriteBinaryCache(fullTrajectoriesPathName);
+            }
+        }
+    }
+    if(result) {
+        _distance = CumulativeDistance(_xCor, _yCor, CMtoM);
     }
     return result;
 }
 
-// init _xCor, _yCor and _zCor
-bool PedData::InitializeVariables(const fs::path & filename)
+namespace
 {
+/// Position of the columns in a data line of the trajectory file
+struct TrajectoryColumns {
+    int id = 0;
+    int fr = 1;
+    int x  = 2;
+    int y  = 3;
+    int z  = 4;
+    int vd = 5; // velocity direction
+};
+
+/// Data lines of a trajectory file in the order of the file
+struct TrajectoryRows {
+    vector<int> ids;    // the Id data from txt format trajectory data
+    vector<int> frames; // the Frame data from txt format trajectory data
     vector<double> xs;
     vector<double> ys;
     vector<double> zs;
-    vector<string> vcmp;    // the direction identification for velocity calculation
-    vector<int> _IdsTXT;    // the Id data from txt format trajectory data
-    vector<int> _FramesTXT; // the Frame data from txt format trajectory data
-    // string fullTrajectoriesPathName= _projectRootDir+"./"+_trajName;
-    ifstream fdata;
-    fdata.open(filename.string());
-    if(fdata.is_open() == false) {
+    vector<string> vcmp; // the direction identification for velocity calculation
+};
+
+inline bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/// Checks for the comment line which defines the columns (#ID FR X Y Z)
+bool IsColumnDefinition(std::string_view line)
+{
+    return line.find("ID") != std::string::npos && line.find("FR") != std::string::npos &&
+           line.find("X") != std::string::npos && line.find("Y") != std::string::npos &&
+           line.find("Z") != std::string::npos;
+}
+
+/// Locale independent replacement for atoi() on a token which is not null terminated
+int ScanInt(std::string_view token)
+{
+    const char * it  = token.data();
+    const char * end = it + token.size();
+    bool negative    = false;
+    if(it != end && (*it == '-' || *it == '+')) {
+        negative = *it == '-';
+        ++it;
+    }
+    int value = 0;
+    for(; it != end && *it >= '0' && *it <= '9'; ++it) {
+        value = value * 10 + (*it - '0');
+    }
+    return negative ? -value : value;
+}
+
+/// Locale independent replacement for atof() on a token which is not null terminated
+double ScanDouble(std::string_view token)
+{
+    if(!token.empty() && token[0] == '+') {
+        token.remove_prefix(1);
+    }
+    double value = 0;
+#if defined(__cpp_lib_to_chars)
+    std::from_chars(token.data(), token.data() + token.size(), value);
+#else
+    // std::from_chars for floating point numbers is not available with this standard library
+    char buffer[64];
+    const std::size_t length = std::min(token.size(), sizeof(buffer) - 1);
+    std::copy_n(token.data(), length, buffer);
+    buffer[length] = '\0';
+    value          = strtod(buffer, nullptr);
+#endif
+    return value;
+}
+
+/// Handles a comment line of the trajectory file (framerate and column definitions)
+void ParseHeaderLine(string line, float & fps, bool & fpsFound, TrajectoryColumns & columns)
+{
+    // looking for the framerate which is supposed to be at the second position
+    if(line.find("framerate") != std::string::npos) {
+        std::vector<std::string> strs;
+        line.erase(0, 1); // remove #
+        boost::split(strs, line, boost::is_any_of(":"), boost::token_compress_on);
+        if(strs.size() > 1) {
+            fps = atof(strs[1].c_str());
+            if(fps == 0.0) // in case not valid fps found
+            {
+                LOG_ERROR("Could not convert fps <{}>", strs[1]);
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            LOG_ERROR("Frame rate fps not defined");
+            exit(EXIT_FAILURE);
+        }
+        LOG_INFO("Frame rate fps: <{:.2f}>", fps);
+        fpsFound = true;
+    }
+    if(IsColumnDefinition(line)) {
+        // looking for this line
+        // #ID  FR  X Y Z
+        std::vector<std::string> strs1;
+        line.erase(0, 1);
+        boost::split(strs1, line, boost::is_any_of("\t\r "), boost::token_compress_on);
+
+        auto position = [&strs1](const char * name) {
+            return (int) std::distance(strs1.begin(), find(strs1.begin(), strs1.end(), name));
+        };
+        columns.id = position("ID");
+        columns.fr = position("FR");
+        columns.x  = position("X");
+        columns.y  = position("Y");
+        columns.z  = position("Z");
+        columns.vd = position("VD");
+    }
+}
+
+/**
+ * Splits a trimmed data line at tabs and blanks and appends its values to rows.
+ * @return false if the velocity direction is requested but missing in the line
+ */
+bool ParseDataLine(
+    std::string_view line,
+    const TrajectoryColumns & columns,
+    bool readVD,
+    TrajectoryRows & rows)
+{
+    constexpr int maxTokens = 32;
+    std::string_view tokens[maxTokens];
+    int numTokens = 0;
+
+    const char * it  = line.data();
+    const char * end = it + line.size();
+    while(it != end) {
+        const char * tokenBegin = it;
+        while(it != end && *it != ' ' && *it != '\t') {
+            ++it;
+        }
+        if(numTokens < maxTokens) {
+            tokens[numTokens] = std::string_view(tokenBegin, it - tokenBegin);
+        }
+        ++numTokens;
+        while(it != end && (*it == ' ' || *it == '\t')) {
+            ++it;
+        }
+    }
+
+    auto token = [&](int pos) {
+        return (pos >= 0 && pos < std::min(numTokens, maxTokens)) ? tokens[pos] :
+                                                                    std::string_view();
+    };
+    rows.ids.push_back(ScanInt(token(columns.id)));
+    rows.frames.push_back(ScanInt(token(columns.fr)));
+    rows.xs.push_back(ScanDouble(token(columns.x)));
+    rows.ys.push_back(ScanDouble(token(columns.y)));
+
+    if(numTokens >= 5)
+        rows.zs.push_back(ScanDouble(token(columns.z)));
+    else
+        rows.zs.push_back(0);
+
+    if(readVD) {
+        if(numTokens >= 6 && columns.vd < numTokens) {
+            rows.vcmp.emplace_back(token(columns.vd));
+        } else {
+            LOG_ERROR("There is no indicator for velocity component in "
+                      "trajectory file or ini file!!");
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Returns the begin of the line following cursor and stores the trimmed current line in line
+const char * NextLine(const char * cursor, const char * end, std::string_view & line)
+{
+    const char * lineEnd = static_cast<const char *>(memchr(cursor, '\n', end - cursor));
+    if(lineEnd == nullptr) {
+        lineEnd = end;
+    }
+    const char * next = lineEnd == end ? end : lineEnd + 1;
+
+    // trim the line
+    while(cursor != lineEnd && IsSpace(*cursor)) {
+        ++cursor;
+    }
+    while(lineEnd != cursor && IsSpace(*(lineEnd - 1))) {
+        --lineEnd;
+    }
+    line = std::string_view(cursor, lineEnd - cursor);
+    return next;
+}
+
+/**
+ * Parses the data lines in [begin, end). Comment lines are not interpreted but collected in
+ * comments, so that chunks of the file can be parsed independently of each other.
+ * @return false if a data line could not be parsed
+ */
+bool ParseDataChunk(
+    const char * begin,
+    const char * end,
+    const TrajectoryColumns & columns,
+    bool readVD,
+    TrajectoryRows & rows,
+    std::vector<std::string_view> & comments)
+{
+    std::string_view line;
+    for(const char * cursor = begin; cursor != end;) {
+        cursor = NextLine(cursor, end, line);
+        if(line.empty()) {
+            continue;
+        }
+        if(line[0] == '#') {
+            comments.push_back(line);
+        } else if(!ParseDataLine(line, columns, readVD, rows)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AppendRows(TrajectoryRows & rows, TrajectoryRows && chunk)
+{
+    rows.ids.insert(rows.ids.end(), chunk.ids.begin(), chunk.ids.end());
+    rows.frames.insert(rows.frames.end(), chunk.frames.begin(), chunk.frames.end());
+    rows.xs.insert(rows.xs.end(), chunk.xs.begin(), chunk.xs.end());
+    rows.ys.insert(rows.ys.end(), chunk.ys.begin(), chunk.ys.end());
+    rows.zs.insert(rows.zs.end(), chunk.zs.begin(), chunk.zs.end());
+    std::move(chunk.vcmp.begin(), chunk.vcmp.end(), std::back_inserter(rows.vcmp));
+    chunk = TrajectoryRows();
+}
+
+/* Layout of the binary trajectory cache (.jpsbin), all values in native byte order:
+ *  CacheHeader
+ *  int32  ID[numPeds]            ID of each pedestrian in order of its index
+ *  int32  firstFrame[numPeds]    _firstFrame
+ *  int32  lastFrame[numPeds]     _lastFrame
+ *  int32  spanFirst[numPeds]     first frame with data of each pedestrian
+ *  int32  spanLength[numPeds]    number of frames from spanFirst to the last frame with data
+ *  int64  frameOffset[numFrames + 1]
+ *  int32  pedsInFrame[numRows]   indices of pedestrians per frame (order of the text file)
+ *  double x[numValues], y[numValues], z[numValues]  positions per pedestrian span
+ */
+constexpr char cacheMagic[8]          = {'J', 'P', 'S', 'B', 'I', 'N', '\0', '\0'};
+constexpr std::uint32_t cacheVersion  = 1;
+constexpr const char * cacheExtension = ".jpsbin";
+
+struct CacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t sourceSize;
+    std::int64_t sourceTime;
+    float fps;
+    std::int32_t minFrame;
+    std::int32_t numFrames;
+    std::int32_t numPeds;
+    std::int32_t minID;
+    std::int32_t maxID;
+    std::uint64_t numRows;
+    std::uint64_t numValues;
+};
+static_assert(sizeof(CacheHeader) == 72, "CacheHeader must not contain padding");
+
+/// Size and modification time of the trajectory file, which identify a matching cache
+bool GetSourceKey(const fs::path & source, std::uint64_t & size, std::int64_t & time)
+{
+    std::error_code ec;
+    size = fs::file_size(source, ec);
+    if(ec) {
+        return false;
+    }
+    auto writeTime = fs::last_write_time(source, ec);
+    if(ec) {
+        return false;
+    }
+    time = writeTime.time_since_epoch().count();
+    return true;
+}
+
+/// Sequential reader on the content of a cache file with bounds checking
+class CacheReader
+{
+public:
+    CacheReader(const char * data, std::size_t size) : _cursor(data), _end(data + size) {}
+
+    template <typename T>
+    bool Read(T * values, std::size_t count)
+    {
+        const std::size_t bytes = count * sizeof(T);
+        if((std::size_t)(_end - _cursor) < bytes) {
+            return false;
+        }
+        std::memcpy(values, _cursor, bytes);
+        _cursor += bytes;
+        return true;
+    }
+
+private:
+    const char * _cursor;
+    const char * _end;
+};
+
+template <typename T>
+void WriteValues(std::ofstream & out, const T * values, std::size_t count)
+{
+    out.write(reinterpret_cast<const char *>(values), count * sizeof(T));
+}
+
+/// name of a temporary file next to the cache, unique across processes and their threads
+fs::path TemporaryCacheName(const fs::path & cacheName)
+{
+    // the process id alone may repeat on other hosts sharing the file system
+    std::random_device random;
+    const std::uint64_t suffix = (std::uint64_t(random()) << 32) | random();
+    return fs::path(cacheName).concat(fmt::format(".{}.{:016x}.tmp", getpid(), suffix));
+}
+} // namespace
+
+// init _xCor, _yCor and _zCor
+bool PedData::InitializeVariables(const fs::path & filename)
+{
+    MappedFile file(filename);
+    if(!file.IsOpen()) {
         LOG_ERROR("could not open the trajectories file <{}>", filename.string());
         return false;
-    } else {
-        string line;
-        int lineNr    = 1;
-        int pos_id    = 0;
-        int pos_fr    = 1;
-        int pos_x     = 2;
-        int pos_y     = 3;
-        int pos_z     = 4;
-        int pos_vd    = 5; // velocity direction
-        int fps_found = 0;
-        while(getline(fdata, line)) {
-            boost::algorithm::trim(line);
-            // looking for the framerate which is supposed to be at the second position
+    }
+
+    TrajectoryRows rows;
+    TrajectoryColumns columns;
+    bool fps_found    = false;
+    const bool readVD = _vComponent == "F";
+
+    // Serial pre-pass over the leading comment lines (framerate and column definitions)
+    const char * cursor    = file.Data();
+    const char * end       = cursor + file.Size();
+    const char * dataBegin = end;
+    std::string_view line;
+    while(cursor != end) {
+        const char * next = NextLine(cursor, end, line);
+        if(!line.empty() && line[0] != '#') {
+            dataBegin = cursor;
+            break;
+        }
+        if(!line.empty()) {
+            ParseHeaderLine(string(line), _fps, fps_found, columns);
+        }
+        cursor = next;
+    }
+    static int once = 1;
+    if(once) {
+        once = 0;
+        LOG_INFO("pos_id: {}", columns.id);
+        LOG_INFO("pos_fr: {}", columns.fr);
+        LOG_INFO("pos_x: {}", columns.x);
+        LOG_INFO("pos_y: {}", columns.y);
+        LOG_INFO("pos_z: {}", columns.z);
+        LOG_INFO("pos_vd: {}", columns.vd);
+    }
+
+    // Split the data section into newline aligned chunks which are parsed in parallel
+    constexpr std::size_t minChunkSize = 1 << 20;
+    const std::size_t dataSize         = end - dataBegin;
+    const int numChunks                = (int) std::clamp<std::size_t>(
+        dataSize / minChunkSize, 1, 4 * (std::size_t) omp_get_max_threads());
+    std::vector<const char *> chunkBegin(numChunks + 1, end);
+    chunkBegin[0] = dataBegin;
+    for(int chunk = 1; chunk < numChunks; chunk++) {
+        const char * pos =
+            std::max(dataBegin + chunk * (dataSize / numChunks), chunkBegin[chunk - 1]);
+        const char * newline = static_cast<const char *>(memchr(pos, '\n', end - pos));
+        chunkBegin[chunk]    = newline == nullptr ? end : newline + 1;
+    }
+
+    std::vector<TrajectoryRows> chunkRows(numChunks);
+    std::vector<std::vector<std::string_view>> chunkComments(numChunks);
+    int parseError = 0;
+#pragma omp parallel for schedule(dynamic) reduction(| : parseError)
+    for(int chunk = 0; chunk < numChunks; chunk++) {
+        if(!ParseDataChunk(
+               chunkBegin[chunk],
+               chunkBegin[chunk + 1],
+               columns,
+               readVD,
+               chunkRows[chunk],
+               chunkComments[chunk])) {
+            parseError = 1;
+        }
+    }
+    if(parseError) {
+        return false;
+    }
+
+    // Comment lines within the data section are handled in file order afterwards. Only if the
+    // columns are redefined there, the data section has to be parsed again line by line.
+    bool columnsRedefined = false;
+    for(const auto & comments : chunkComments) {
+        for(std::string_view comment : comments) {
+            columnsRedefined = columnsRedefined || IsColumnDefinition(comment);
+        }
+    }
+    if(columnsRedefined) {
+        LOG_INFO("Column definition within the trajectory data, parsing the file serially");
+        chunkRows = std::vector<TrajectoryRows>(1);
+        for(cursor = dataBegin; cursor != end;) {
+            cursor = NextLine(cursor, end, line);
+            if(line.empty()) {
+                continue;
+            }
             if(line[0] == '#') {
-                if(line.find("framerate") != std::string::npos) {
-                    std::vector<std::string> strs;
-                    line.erase(0, 1); // remove #
-                    boost::split(strs, line, boost::is_any_of(":"), boost::token_compress_on);
-                    if(strs.size() > 1) {
-                        _fps = atof(strs[1].c_str());
-                        if(_fps == 0.0) // in case not valid fps found
-                        {
-                            LOG_ERROR("Could not convert fps <{}>", strs[1]);
-                            exit(EXIT_FAILURE);
-                        }
-                    } else {
-                        LOG_ERROR("Frame rate fps not defined");
-                        exit(EXIT_FAILURE);
-                    }
-                    LOG_INFO("Frame rate fps: <{:.2f}>", _fps);
-                    fps_found = 1;
-                }
-                if(line.find("ID") != std::string::npos && line.find("FR") != std::string::npos &&
-                   line.find("X") != std::string::npos && line.find("Y") != std::string::npos &&
-                   line.find("Z") != std::string::npos) {
-                    // looking for this line
-                    // #ID  FR  X Y Z
-                    // std::cout << "0. line <" << line << ">\n";
-                    std::vector<std::string> strs1;
-                    line.erase(0, 1);
-                    // std::cout << "1. line <" << line << ">\n";
-                    boost::split(strs1, line, boost::is_any_of("\t\r "), boost::token_compress_on);
-                    // std::cout << "str size = " << strs1.size() << "\n";
-                    // for(auto s: strs1)
-                    //      std::cout << "s <" << s  << ">\n";
-
-                    vector<string>::iterator it_id;
-                    it_id  = find(strs1.begin(), strs1.end(), "ID");
-                    pos_id = std::distance(strs1.begin(), it_id);
-                    it_id  = find(strs1.begin(), strs1.end(), "FR");
-                    pos_fr = std::distance(strs1.begin(), it_id);
-                    it_id  = find(strs1.begin(), strs1.end(), "X");
-                    pos_x  = std::distance(strs1.begin(), it_id);
-                    it_id  = find(strs1.begin(), strs1.end(), "Y");
-                    pos_y  = std::distance(strs1.begin(), it_id);
-                    it_id  = find(strs1.begin(), strs1.end(), "Z");
-                    pos_z  = std::distance(strs1.begin(), it_id);
-                    it_id  = find(strs1.begin(), strs1.end(), "VD");
-                    pos_vd = std::distance(strs1.begin(), it_id);
-                }
-
-            } else if(line[0] != '#' && !(line.empty())) {
-                static int once = 1;
-                std::vector<std::string> strs;
-                boost::split(strs, line, boost::is_any_of("\t "), boost::token_compress_on);
-                if(lineNr % 100000 == 0)
-                    LOG_INFO("lineNr {}", lineNr);
-
-                if(once) // && strs.size() < 5
-                {
-                    once = 0;
-                    LOG_INFO("pos_id: {}", pos_id);
-                    LOG_INFO("pos_fr: {}", pos_fr);
-                    LOG_INFO("pos_x: {}", pos_x);
-                    LOG_INFO("pos_y: {}", pos_y);
-                    LOG_INFO("pos_z: {}", pos_z);
-                    LOG_INFO("pos_vd: {}", pos_vd);
-                }
-                _IdsTXT.push_back(atoi(strs[pos_id].c_str()));
-                _FramesTXT.push_back(atoi(strs[pos_fr].c_str()));
-                xs.push_back(atof(strs[pos_x].c_str()));
-                ys.push_back(atof(strs[pos_y].c_str()));
-
-                if(strs.size() >= 5)
-                    zs.push_back(atof(strs[pos_z].c_str()));
-                else
-                    zs.push_back(0);
-
-                if(_vComponent == "F") {
-                    if(strs.size() >= 6 && pos_vd < (int) strs.size()) {
-                        vcmp.push_back(strs[pos_vd].c_str());
-                    } else {
-                        LOG_ERROR("There is no indicator for velocity component in "
-                                  "trajectory file or ini file!!");
-                        return false;
-                    }
-                }
+                ParseHeaderLine(string(line), _fps, fps_found, columns);
+            } else if(!ParseDataLine(line, columns, readVD, chunkRows[0])) {
+                return false;
+            }
+        }
+    } else {
+        for(const auto & comments : chunkComments) {
+            for(std::string_view comment : comments) {
+                ParseHeaderLine(string(comment), _fps, fps_found, columns);
             }
-            lineNr++;
-        } // while
-        if(fps_found == 0) {
-            LOG_ERROR("Frame rate fps ia not defined ");
-            exit(EXIT_FAILURE);
         }
-        LOG_INFO("Finished reading the data");
+    }
+    if(!fps_found) {
+        LOG_ERROR("Frame rate fps ia not defined ");
+        exit(EXIT_FAILURE);
     }
 
-    fdata.close();
-    LOG_INFO("Got {} lines", _IdsTXT.size());
-    _minID = *min_element(_IdsTXT.begin(), _IdsTXT.end());
-    _maxID = *max_element(_IdsTXT.begin(), _IdsTXT.end());
+    std::size_t numRows = 0;
+    for(const auto & chunk : chunkRows) {
+        numRows += chunk.ids.size();
+    }
+    rows.ids.reserve(numRows);
+    rows.frames.reserve(numRows);
+    rows.xs.reserve(numRows);
+    rows.ys.reserve(numRows);
+    rows.zs.reserve(numRows);
+    rows.vcmp.reserve(readVD ? numRows : 0);
+    for(auto & chunk : chunkRows) {
+        AppendRows(rows, std::move(chunk));
+    }
+    LOG_INFO("Finished reading the data");
+
+    LOG_INFO("Got {} lines", rows.ids.size());
+    if(rows.ids.empty()) {
+        LOG_ERROR("There are no trajectory data in file <{}>", filename.string());
+        return false;
+    }
+
+    // Assign each pedestrian a dense index in order of its first appearance in the file and
+    // collect the per-pedestrian statistics in the same pass.
+    std::unordered_map<int, int> idToIndex; // ID in file -> position in unique_ids
+    std::vector<int> unique_ids;
+    std::vector<int> firstRow;  // first row of a pedestrian in the trajectory file
+    std::vector<int> lastRow;   // last row of a pedestrian in the trajectory file
+    std::vector<int> totalRows; // the total data points of a pedestrian in the trajectory
+    std::vector<int> spanBegin; // smallest frame of a pedestrian in the trajectory file
+    std::vector<int> spanEnd;   // largest frame of a pedestrian in the trajectory file
+    std::vector<int> rowIndex(rows.ids.size()); // position in unique_ids for each row
+    _minID       = rows.ids[0];
+    _maxID       = rows.ids[0];
+    _minFrame    = rows.frames[0];
+    int maxFrame = rows.frames[0];
+    for(int row = 0; row < (int) rows.ids.size(); row++) {
+        const int id    = rows.ids[row];
+        const int frame = rows.frames[row];
+        _minID          = std::min(_minID, id);
+        _maxID          = std::max(_maxID, id);
+        _minFrame       = std::min(_minFrame, frame);
+        maxFrame        = std::max(maxFrame, frame);
+
+        auto [it, inserted] = idToIndex.try_emplace(id, (int) unique_ids.size());
+        if(inserted) {
+            unique_ids.push_back(id);
+            firstRow.push_back(row);
+            lastRow.push_back(row);
+            totalRows.push_back(0);
+            spanBegin.push_back(frame);
+            spanEnd.push_back(frame);
+        }
+        const int id_pos  = it->second;
+        lastRow[id_pos]   = row;
+        spanBegin[id_pos] = std::min(spanBegin[id_pos], frame);
+        spanEnd[id_pos]   = std::max(spanEnd[id_pos], frame);
+        totalRows[id_pos]++;
+        rowIndex[row] = id_pos;
+    }
     LOG_INFO("minID: {}", _minID);
     LOG_INFO("maxID: {}", _maxID);
-    _minFrame = *min_element(_FramesTXT.begin(), _FramesTXT.end());
     LOG_INFO("minFrame: {}", _minFrame);
     // Total number of frames
-    _numFrames = *max_element(_FramesTXT.begin(), _FramesTXT.end()) - _minFrame + 1;
+    _numFrames = maxFrame - _minFrame + 1;
     LOG_INFO("numFrames: {}", _numFrames);
 
     // Total number of agents
-
-    std::unordered_set<int> s;
-    std::vector<int> unique_ids(_IdsTXT);
-    auto end = std::remove_if(
-        unique_ids.begin(), unique_ids.end(), [&s](int const & i) { return !s.insert(i).second; });
-
-    unique_ids.erase(end, unique_ids.end());
     _numPeds = unique_ids.size();
     LOG_INFO("INFO: Total number of Agents: {}", _numPeds);
-    CreateGlobalVariables(_numPeds, _numFrames);
+    for(int i = 0; i < _numPeds; i++) {
+        spanEnd[i]   = spanEnd[i] - spanBegin[i] + 1;
+        spanBegin[i] = spanBegin[i] - _minFrame;
+    }
+    CreateGlobalVariables(spanBegin, spanEnd);
     LOG_INFO("Create Global Variables done");
-    for(int i = 0; i < (int) unique_ids.size(); i++) {
-        int firstFrameIndex   = INT_MAX; // The first frame index of a pedestrian
-        int lastFrameIndex    = -1;      // The last frame index of a pedestrian
-        int actual_totalframe = 0;       // The total data points of a pedestrian in the trajectory
-        int pos_i             = i;       // std::distance(_IdsTXT.begin(), &i);
-        for(auto j = _IdsTXT.begin(); j != _IdsTXT.end(); ++j) {
-            if(*j == unique_ids[i]) {
-                int pos = std::distance(_IdsTXT.begin(), j);
-                if(pos < firstFrameIndex) {
-                    firstFrameIndex = pos;
-                }
-                if(pos > lastFrameIndex) {
-                    lastFrameIndex = pos;
-                }
-                actual_totalframe++;
-            }
-        }
-        if(lastFrameIndex <= 0 || firstFrameIndex == INT_MAX) {
+    _pedIds = unique_ids;
+    for(int i = 0; i < _numPeds; i++) {
+        if(lastRow[i] <= 0) {
             LOG_WARNING("There is no trajectory for ped with ID <{}>!", unique_ids[i]);
             continue;
         }
-        _firstFrame[pos_i]    = _FramesTXT[firstFrameIndex] - _minFrame;
-        _lastFrame[pos_i]     = _FramesTXT[lastFrameIndex] - _minFrame;
-        int expect_totalframe = _lastFrame[pos_i] - _firstFrame[pos_i] + 1;
-        if(actual_totalframe != expect_totalframe) {
+        _firstFrame[i]        = rows.frames[firstRow[i]] - _minFrame;
+        _lastFrame[i]         = rows.frames[lastRow[i]] - _minFrame;
+        int expect_totalframe = _lastFrame[i] - _firstFrame[i] + 1;
+        if(totalRows[i] != expect_totalframe) {
             LOG_ERROR(
                 "The trajectory of ped with ID <{}> is not continuous. Please modify the "
                 "trajectory file!",
-                _IdsTXT[pos_i]);
+                unique_ids[i]);
             LOG_ERROR(
                 "actual_totalfame = <{}>, expected_totalframe = <{}>",
-                actual_totalframe,
+                totalRows[i],
                 expect_totalframe);
             return false;
         }
     }
     LOG_INFO("convert x and y");
-    for(unsigned int i = 0; i < _IdsTXT.size(); i++) {
-        int id_pos = 0; // position in array unique_ids
-        //---------- get position of index in unique index vector ---------------
-        auto it_uid = std::find(unique_ids.begin(), unique_ids.end(), _IdsTXT[i]);
-        if(it_uid == unique_ids.end()) {
-            LOG_ERROR("Id {} does not exist in file", _IdsTXT[i]);
-            return false;
-        } else {
-            id_pos = std::distance(unique_ids.begin(), it_uid);
-        }
-        //--------------------
-        int frm  = _FramesTXT[i] - _minFrame;
-        double x = xs[i] * M2CM;
-        double y = ys[i] * M2CM;
-        double z = zs[i] * M2CM;
+    std::vector<std::int64_t> frameOffsets(_numFrames + 1, 0);
+    for(unsigned int i = 0; i < rows.ids.size(); i++) {
+        int id_pos = rowIndex[i]; // position in array unique_ids
+        int frm    = rows.frames[i] - _minFrame;
+        double x   = rows.xs[i] * M2CM;
+        double y   = rows.ys[i] * M2CM;
+        double z   = rows.zs[i] * M2CM;
 
         /* structure of these matrices
          * line:  position id in unique_ids
          * column: frame id - minFrame
          */
-        _xCor(id_pos, frm) = x;
-        _yCor(id_pos, frm) = y;
-        _zCor(id_pos, frm) = z;
-        _id(id_pos, frm)   = _IdsTXT[i];
+        _xCor.Ref(id_pos, frm) = x;
+        _yCor.Ref(id_pos, frm) = y;
+        _zCor.Ref(id_pos, frm) = z;
         if(_vComponent == "F") {
-            _vComp(id_pos, frm) = vcmp[i];
-        } else {
-            _vComp(id_pos, frm) = _vComponent;
+            _vComp.Ref(id_pos, frm) = GetDirectionIndex(rows.vcmp[i]);
         }
+        frameOffsets[frm + 1]++;
     }
-    LOG_INFO("Save the data for each frame");
 
-    // save the data for each frame
-    for(unsigned int i = 0; i < _FramesTXT.size(); i++) {
-        int id_pos = 0;
-        auto itIds = std::find(unique_ids.begin(), unique_ids.end(), _IdsTXT[i]);
-        if(itIds == unique_ids.end()) {
-            LOG_ERROR("Id {} does not exist in file", _IdsTXT[i]);
-            return false;
-        } else {
-            id_pos = std::distance(unique_ids.begin(), itIds);
-        }
-        int t = _FramesTXT[i] - _minFrame;
-        /* structure of peds_t
-         *
-         * index: frame id - minFrame, value: position id in unique_ids
-         */
+    /* structure of peds_t
+     *
+     * index: frame id - minFrame, value: position id in unique_ids
+     */
+    for(int frm = 0; frm < _numFrames; frm++) {
+        frameOffsets[frm + 1] += frameOffsets[frm];
+    }
+    std::vector<std::int64_t> next(frameOffsets.begin(), frameOffsets.end() - 1);
+    std::vector<int> pedsInFrame(rows.ids.size());
+    for(unsigned int i = 0; i < rows.ids.size(); i++) {
+        pedsInFrame[next[rows.frames[i] - _minFrame]++] = rowIndex[i];
+    }
+    _pedIDsByFrameNr = FrameIndex(std::move(frameOffsets), std::move(pedsInFrame));
+
+    return true;
+}
 
-        _pedIDsByFrameNr[t].push_back(id_pos);
-        // std::cout << "frame: " << _FramesTXT[i] << " t: " << t << " > " << id_pos << "\n";
+bool PedData::ReadBinaryCache(const fs::path & source)
+{
+    const fs::path cacheName = fs::path(source).concat(cacheExtension);
+    std::error_code ec;
+    if(!fs::exists(cacheName, ec)) {
+        return false;
+    }
+    std::uint64_t sourceSize;
+    std::int64_t sourceTime;
+    if(!GetSourceKey(source, sourceSize, sourceTime)) {
+        return false;
+    }
+    MappedFile file(cacheName);
+    if(!file.IsOpen()) {
+        return false;
     }
 
+    CacheReader reader(file.Data(), file.Size());
+    CacheHeader header;
+    if(!reader.Read(&header, 1) || std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+       header.version != cacheVersion || header.numPeds < 0 || header.numFrames <= 0) {
+        LOG_WARNING("Ignoring invalid trajectory cache <{}>", cacheName.string());
+        return false;
+    }
+    if(header.sourceSize != sourceSize || header.sourceTime != sourceTime) {
+        LOG_INFO("Trajectory cache <{}> is outdated", cacheName.string());
+        return false;
+    }
+
+    const std::size_t numPeds  = header.numPeds;
+    const std::size_t expected = sizeof(CacheHeader) + 5 * numPeds * sizeof(std::int32_t) +
+                                 (header.numFrames + 1) * sizeof(std::int64_t) +
+                                 header.numRows * sizeof(std::int32_t) +
+                                 3 * header.numValues * sizeof(double);
+    if(file.Size() != expected) {
+        LOG_WARNING("Ignoring invalid trajectory cache <{}>", cacheName.string());
+        return false;
+    }
+    vector<int> ids(numPeds), firstFrame(numPeds), lastFrame(numPeds), spanFirst(numPeds),
+        spanLength(numPeds);
+    vector<std::int64_t> frameOffset(header.numFrames + 1);
+    vector<int> pedsInFrame(header.numRows);
+    bool valid = reader.Read(ids.data(), numPeds) && reader.Read(firstFrame.data(), numPeds) &&
+                 reader.Read(lastFrame.data(), numPeds) &&
+                 reader.Read(spanFirst.data(), numPeds) &&
+                 reader.Read(spanLength.data(), numPeds) &&
+                 reader.Read(frameOffset.data(), frameOffset.size()) &&
+                 reader.Read(pedsInFrame.data(), pedsInFrame.size());
+    std::uint64_t numValues = 0;
+    for(std::size_t i = 0; valid && i < numPeds; i++) {
+        valid = spanFirst[i] >= 0 && spanLength[i] >= 0 &&
+                spanFirst[i] + spanLength[i] <= header.numFrames;
+        numValues += spanLength[i];
+    }
+    valid = valid && numValues == header.numValues && frameOffset.front() == 0 &&
+            frameOffset.back() == (std::int64_t) header.numRows &&
+            std::is_sorted(frameOffset.begin(), frameOffset.end()) &&
+            std::all_of(pedsInFrame.begin(), pedsInFrame.end(), [numPeds](int i) {
+                return i >= 0 && i < (int) numPeds;
+            });
+    if(!valid) {
+        LOG_WARNING("Ignoring invalid trajectory cache <{}>", cacheName.string());
+        return false;
+    }
+
+    LOG_INFO("Reading trajectory data from cache <{}>", cacheName.string());
+    _fps       = header.fps;
+    _minFrame  = header.minFrame;
+    _numFrames = header.numFrames;
+    _numPeds   = header.numPeds;
+    _minID     = header.minID;
+    _maxID     = header.maxID;
+    LOG_INFO("Frame rate fps: <{:.2f}>", _fps);
+    LOG_INFO("minID: {}", _minID);
+    LOG_INFO("maxID: {}", _maxID);
+    LOG_INFO("minFrame: {}", _minFrame);
+    LOG_INFO("numFrames: {}", _numFrames);
+    LOG_INFO("INFO: Total number of Agents: {}", _numPeds);
+
+    CreateGlobalVariables(spanFirst, spanLength);
+    _firstFrame = std::move(firstFrame);
+    _lastFrame  = std::move(lastFrame);
+    _pedIds     = std::move(ids);
+    reader.Read(_xCor.Span(0), numValues);
+    reader.Read(_yCor.Span(0), numValues);
+    reader.Read(_zCor.Span(0), numValues);
+    _pedIDsByFrameNr = FrameIndex(std::move(frameOffset), std::move(pedsInFrame));
     return true;
 }
 
-vector<double> PedData::GetVInFrame(int frame, const vector<int> & ids, double zPos) const
+void PedData::WriteBinaryCache(const fs::path & source) const
+{
+    std::uint64_t sourceSize;
+    std::int64_t sourceTime;
+    if(!GetSourceKey(source, sourceSize, sourceTime)) {
+        return;
+    }
+
+    vector<int> spanFirst(_numPeds), spanLength(_numPeds);
+    for(int i = 0; i < _numPeds; i++) {
+        spanFirst[i]  = _xCor.FirstFrame(i);
+        spanLength[i] = _xCor.NumFrames(i);
+    }
+    const auto & frameOffset = _pedIDsByFrameNr.Offsets();
+    const auto & pedsInFrame = _pedIDsByFrameNr.Indices();
+    const std::size_t numValues = _xCor.NumValues();
+
+    CacheHeader header{};
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version    = cacheVersion;
+    header.sourceSize = sourceSize;
+    header.sourceTime = sourceTime;
+    header.fps        = _fps;
+    header.minFrame   = _minFrame;
+    header.numFrames  = _numFrames;
+    header.numPeds    = _numPeds;
+    header.minID      = _minID;
+    header.maxID      = _maxID;
+    header.numRows    = pedsInFrame.size();
+    header.numValues  = numValues;
+
+    // write to a temporary file first, so that concurrent runs never see an incomplete cache
+    const fs::path cacheName = fs::path(source).concat(cacheExtension);
+    const fs::path tmpName   = TemporaryCacheName(cacheName);
+    {
+        std::ofstream out(tmpName, std::ios::binary | std::ios::trunc);
+        if(!out.is_open()) {
+            LOG_WARNING("Could not write trajectory cache <{}>", cacheName.string());
+            return;
+        }
+        WriteValues(out, &header, 1);
+        WriteValues(out, _pedIds.data(), _pedIds.size());
+        WriteValues(out, _firstFrame.data(), _firstFrame.size());
+        WriteValues(out, _lastFrame.data(), _lastFrame.size());
+        WriteValues(out, spanFirst.data(), spanFirst.size());
+        WriteValues(out, spanLength.data(), spanLength.size());
+        WriteValues(out, frameOffset.data(), frameOffset.size());
+        WriteValues(out, pedsInFrame.data(), pedsInFrame.size());
+        WriteValues(out, _xCor.Span(0), numValues);
+        WriteValues(out, _yCor.Span(0), numValues);
+        WriteValues(out, _zCor.Span(0), numValues);
+        if(!out.good()) {
+            out.close();
+            std::error_code ec;
+            fs::remove(tmpName, ec);
+            LOG_WARNING("Could not write trajectory cache <{}>", cacheName.string());
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmpName, cacheName, ec);
+    if(ec) {
+        fs::remove(tmpName, ec);
+        LOG_WARNING("Could not write trajectory cache <{}>", cacheName.string());
+        return;
+    }
+    LOG_INFO("Wrote trajectory cache <{}>", cacheName.string());
+}
+
+vector<double> PedData::GetVInFrame(int frame, IndexRange ids, double zPos) const
 {
     vector<double> VInFrame;
     for(unsigned int i = 0; i < ids.size(); i++) {
         int id      = ids[i];
         int Tpast   = frame - _deltaF;
         int Tfuture = frame + _deltaF;
-        double v    = GetInstantaneousVelocity1(
-            frame, Tpast, Tfuture, id, _firstFrame, _lastFrame, _xCor, _yCor);
+        double v    = _velocityValid ? _velocity(id, frame) :
+                                       GetInstantaneousVelocity1(
+                                        frame,
+                                        Tpast,
+                                        Tfuture,
+                                        id,
+                                        _firstFrame,
+                                        _lastFrame,
+                                        _xCor,
+                                        _yCor);
         // TODO: zPos is set to 10000001.0 if it's None. Needed for this if-clause. But why?
         if(zPos < 1000000.0) {
             if(fabs(_zCor(id, frame) - zPos * M2CM) < J_EPS_EVENT) {
@@ -337,7 +856,7 @@ vector<double> PedData::GetVInFrame(int frame, const vector<int> & ids, double z
     return VInFrame;
 }
 
-vector<double> PedData::GetXInFrame(int frame, const vector<int> & ids, double zPos) const
+vector<double> PedData::GetXInFrame(int frame, IndexRange ids, double zPos) const
 {
     vector<double> XInFrame;
     for(int id : ids) {
@@ -353,7 +872,7 @@ vector<double> PedData::GetXInFrame(int frame, const vector<int> & ids, double z
     return XInFrame;
 }
 
-vector<double> PedData::GetXInFrame(int frame, const vector<int> & ids) const
+vector<double> PedData::GetXInFrame(int frame, IndexRange ids) const
 {
     vector<double> XInFrame;
     for(int id : ids) {
@@ -362,7 +881,7 @@ vector<double> PedData::GetXInFrame(int frame, const vector<int> & ids) const
     return XInFrame;
 }
 
-vector<double> PedData::GetYInFrame(int frame, const vector<int> & ids, double zPos) const
+vector<double> PedData::GetYInFrame(int frame, IndexRange ids, double zPos) const
 {
     vector<double> YInFrame;
     for(unsigned int i = 0; i < ids.size(); i++) {
@@ -379,7 +898,7 @@ vector<double> PedData::GetYInFrame(int frame, const vector<int> & ids, double z
     return YInFrame;
 }
 
-vector<double> PedData::GetYInFrame(int frame, const vector<int> & ids) const
+vector<double> PedData::GetYInFrame(int frame, IndexRange ids) const
 {
     vector<double> YInFrame;
     for(unsigned int i = 0; i < ids.size(); i++) {
@@ -389,7 +908,7 @@ vector<double> PedData::GetYInFrame(int frame, const vector<int> & ids) const
     return YInFrame;
 }
 
-vector<double> PedData::GetZInFrame(int frame, const vector<int> & ids) const
+vector<double> PedData::GetZInFrame(int frame, IndexRange ids) const
 {
     vector<double> ZInFrame;
     for(unsigned int i = 0; i < ids.size(); i++) {
@@ -398,7 +917,7 @@ vector<double> PedData::GetZInFrame(int frame, const vector<int> & ids) const
     }
     return ZInFrame;
 }
-vector<double> PedData::GetZInFrame(int frame, const vector<int> & ids, double zPos) const
+vector<double> PedData::GetZInFrame(int frame, IndexRange ids, double zPos) const
 {
     vector<double> ZInFrame;
     for(unsigned int i = 0; i < ids.size(); i++) {
@@ -415,21 +934,29 @@ vector<double> PedData::GetZInFrame(int frame, const vector<int> & ids, double z
     return ZInFrame;
 }
 
-vector<int> PedData::GetIdInFrame(int frame, const vector<int> & ids) const
+vector<int> PedData::GetIdInFrame(int /*frame*/, IndexRange ids) const
 {
     vector<int> IdInFrame;
     for(int id : ids) {
-        IdInFrame.push_back(_id(id, frame));
+        IdInFrame.push_back(_pedIds[id]);
     }
     return IdInFrame;
 }
 
-int PedData::GetId(int frame, int id) const
+int PedData::GetId(int /*frame*/, int id) const
+{
+    return _pedIds[id];
+}
+
+bool PedData::IsAtHeight(int id, int frame, double zPos) const
 {
-    return _id(id, frame);
+    if(zPos < 1000000.0) {
+        return fabs(_zCor(id, frame) - zPos * M2CM) < J_EPS_EVENT;
+    }
+    return true;
 }
 
-vector<int> PedData::GetIndexInFrame(int frame, const vector<int> & ids, double zPos) const
+vector<int> PedData::GetIndexInFrame(int frame, IndexRange ids, double zPos) const
 {
     vector<int> IdInFrame;
     for(int id : ids) {
@@ -445,64 +972,59 @@ vector<int> PedData::GetIndexInFrame(int frame, const vector<int> & ids, double
     return IdInFrame;
 }
 
-vector<int> PedData::GetIdInFrame(int frame, const vector<int> & ids, double zPos) const
+vector<int> PedData::GetIdInFrame(int frame, IndexRange ids, double zPos) const
 {
     vector<int> IdInFrame;
     for(int id : ids) {
         // TODO: zPos is set to 10000001.0 if it's None. Needed for this if-clause. But why?
         if(zPos < 1000000.0) {
             if(fabs(_zCor(id, frame) - zPos * M2CM) < J_EPS_EVENT) {
-                // IdInFrame.push_back(id +_minID);
-                IdInFrame.push_back(_id(id, frame));
+                IdInFrame.push_back(_pedIds[id]);
             }
         } else {
-            // IdInFrame.push_back(id +_minID);
-            IdInFrame.push_back(_id(id, frame));
+            IdInFrame.push_back(_pedIds[id]);
         }
     }
     return IdInFrame;
 }
 
-double PedData::GetInstantaneousVelocity(
+double PedData::GetInstantaneousVelocity1(
     int Tnow,
     int Tpast,
     int Tfuture,
     int ID,
     const std::vector<int> & Tfirst,
     const std::vector<int> & Tlast,
-    const ub::matrix<double> & Xcor,
-    const ub::matrix<double> & Ycor) const
+    const TrajectoryMatrix<double> & Xcor,
+    const TrajectoryMatrix<double> & Ycor) const
 {
-    std::string vcmp = _vComp(ID, Tnow);
-    double v         = 0.0;
-    // check the component used in the calculation of velocity
-    if(vcmp == "X" || vcmp == "X+" || vcmp == "X-") {
+    const MovementDirection & direction = GetMovementDirection(ID, Tnow);
+    double v                            = 0.0;
+    if(!direction.both) // check the component used in the calculation of velocity
+    {
         if((Tpast >= Tfirst[ID]) && (Tfuture <= Tlast[ID])) {
-            v = _fps * CMtoM * (Xcor(ID, Tfuture) - Xcor(ID, Tpast)) /
-                (2.0 * _deltaF); // one dimensional velocity
+            v = _fps * CMtoM *
+                ((Xcor(ID, Tfuture) - Xcor(ID, Tpast)) * direction.cosAlpha +
+                 (Ycor(ID, Tfuture) - Ycor(ID, Tpast)) * direction.sinAlpha) /
+                (2.0 * _deltaF);
         } else if((Tpast < Tfirst[ID]) && (Tfuture <= Tlast[ID])) {
-            v = _fps * CMtoM * (Xcor(ID, Tfuture) - Xcor(ID, Tnow)) /
+            v = _fps * CMtoM *
+                ((Xcor(ID, Tfuture) - Xcor(ID, Tnow)) * direction.cosAlpha +
+                 (Ycor(ID, Tfuture) - Ycor(ID, Tnow)) * direction.sinAlpha) /
                 (_deltaF); // one dimensional velocity
         } else if((Tpast >= Tfirst[ID]) && (Tfuture > Tlast[ID])) {
-            v = _fps * CMtoM * (Xcor(ID, Tnow) - Xcor(ID, Tpast)) /
+            v = _fps * CMtoM *
+                ((Xcor(ID, Tnow) - Xcor(ID, Tpast)) * direction.cosAlpha +
+                 (Ycor(ID, Tnow) - Ycor(ID, Tpast)) * direction.sinAlpha) /
                 (_deltaF); // one dimensional velocity
         }
-        if((vcmp == "X+" && v < 0) || (vcmp == "X-" && v > 0)) // no moveback
+        if(_IgnoreBackwardMovement &&
+           v < 0) // if no move back and pedestrian moves back, his velocity is set as 0;
+        {
             v = 0;
-    } else if(vcmp == "Y" || vcmp == "Y+" || vcmp == "Y-") {
-        if((Tpast >= Tfirst[ID]) && (Tfuture <= Tlast[ID])) {
-            v = _fps * CMtoM * (Ycor(ID, Tfuture) - Ycor(ID, Tpast)) /
-                (2.0 * _deltaF); // one dimensional velocity
-        } else if((Tpast < Tfirst[ID]) && (Tfuture <= Tlast[ID])) {
-            v = _fps * CMtoM * (Ycor(ID, Tfuture) - Ycor(ID, Tnow)) /
-                (_deltaF); // one dimensional velocity
-        } else if((Tpast >= Tfirst[ID]) && (Tfuture > Tlast[ID])) {
-            v = _fps * CMtoM * (Ycor(ID, Tnow) - Ycor(ID, Tpast)) /
-                (_deltaF); // one dimensional velocity
         }
-        if((vcmp == "Y+" && v < 0) || (vcmp == "Y-" && v > 0)) // no moveback
-            v = 0;
-    } else if(vcmp == "B") {
+
+    } else {
         if((Tpast >= Tfirst[ID]) && (Tfuture <= Tlast[ID])) {
             v = _fps * CMtoM *
                 sqrt(
@@ -524,110 +1046,141 @@ double PedData::GetInstantaneousVelocity(
         }
     }
 
-    return fabs(v);
+    return v;
 }
 
-double PedData::GetInstantaneousVelocity1(
-    int Tnow,
-    int Tpast,
-    int Tfuture,
-    int ID,
-    const std::vector<int> & Tfirst,
-    const std::vector<int> & Tlast,
-    const ub::matrix<double> & Xcor,
-    const ub::matrix<double> & Ycor) const
+PedData::MovementDirection PedData::ParseMovementDirection(const std::string & vcmp)
 {
-    std::string vcmp = _vComp(ID, Tnow); // the vcmp is the angle from 0 to 360
+    MovementDirection direction;
+    if(vcmp == "B") {
+        return direction;
+    }
+    // the vcmp is the angle from 0 to 360
+    std::string angle = vcmp;
     if(vcmp == "X+") {
-        vcmp = "0";
+        angle = "0";
     } else if(vcmp == "Y+") {
-        vcmp = "90";
+        angle = "90";
+    } else if(vcmp == "X-") {
+        angle = "180";
+    } else if(vcmp == "Y-") {
+        angle = "270";
     }
-    if(vcmp == "X-") {
-        vcmp = "180";
+    float alpha        = atof(angle.c_str()) * 2 * M_PI / 360.0;
+    direction.both     = false;
+    direction.cosAlpha = cos(alpha);
+    direction.sinAlpha = sin(alpha);
+    return direction;
+}
+
+std::uint32_t PedData::GetDirectionIndex(const std::string & vcmp)
+{
+    auto [it, inserted] = _directionIndex.try_emplace(vcmp, (std::uint32_t) _directions.size());
+    if(inserted) {
+        _directions.push_back(ParseMovementDirection(vcmp));
     }
-    if(vcmp == "Y-") {
-        vcmp = "270";
+    return it->second;
+}
+
+const PedData::MovementDirection & PedData::GetMovementDirection(int ID, int frame) const
+{
+    return _vComponent == "F" ? _directions[_vComp(ID, frame)] : _directions[0];
+}
+
+void PedData::PrecomputeVelocities()
+{
+    if(_velocityValid) {
+        return;
     }
-    double v = 0.0;
-    if(vcmp != "B") // check the component used in the calculation of velocity
-    {
-        float alpha = atof(vcmp.c_str()) * 2 * M_PI / 360.0;
+    std::vector<int> firstFrame(_numPeds);
+    std::vector<int> numFrames(_numPeds);
+    for(int i = 0; i < _numPeds; i++) {
+        firstFrame[i] = _xCor.FirstFrame(i);
+        numFrames[i]  = _xCor.NumFrames(i);
+    }
+    _velocity = TrajectoryMatrix<double>(firstFrame, numFrames);
+#pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < _numPeds; i++) {
+        FillVelocities(i);
+    }
+    _velocityValid = true;
+}
 
-        if((Tpast >= Tfirst[ID]) && (Tfuture <= Tlast[ID])) {
-            v = _fps * CMtoM *
-                ((Xcor(ID, Tfuture) - Xcor(ID, Tpast)) * cos(alpha) +
-                 (Ycor(ID, Tfuture) - Ycor(ID, Tpast)) * sin(alpha)) /
-                (2.0 * _deltaF);
-        } else if((Tpast < Tfirst[ID]) && (Tfuture <= Tlast[ID])) {
-            v = _fps * CMtoM *
-                ((Xcor(ID, Tfuture) - Xcor(ID, Tnow)) * cos(alpha) +
-                 (Ycor(ID, Tfuture) - Ycor(ID, Tnow)) * sin(alpha)) /
-                (_deltaF); // one dimensional velocity
-        } else if((Tpast >= Tfirst[ID]) && (Tfuture > Tlast[ID])) {
-            v = _fps * CMtoM *
-                ((Xcor(ID, Tnow) - Xcor(ID, Tpast)) * cos(alpha) +
-                 (Ycor(ID, Tnow) - Ycor(ID, Tpast)) * sin(alpha)) /
-                (_deltaF); // one dimensional velocity
-        }
-        if(_IgnoreBackwardMovement &&
-           v < 0) // if no move back and pedestrian moves back, his velocity is set as 0;
-        {
-            v = 0;
-        }
+void PedData::FillVelocities(int ID)
+{
+    const int first = _velocity.FirstFrame(ID);
+    const int end   = first + _velocity.NumFrames(ID);
+    double * v      = _velocity.Span(ID);
 
-    } else if(vcmp == "B") {
-        if((Tpast >= Tfirst[ID]) && (Tfuture <= Tlast[ID])) {
-            v = _fps * CMtoM *
-                sqrt(
-                    pow((Xcor(ID, Tfuture) - Xcor(ID, Tpast)), 2) +
-                    pow((Ycor(ID, Tfuture) - Ycor(ID, Tpast)), 2)) /
-                (2.0 * _deltaF); // two dimensional velocity
-        } else if((Tpast < Tfirst[ID]) && (Tfuture <= Tlast[ID])) {
-            v = _fps * CMtoM *
-                sqrt(
-                    pow((Xcor(ID, Tfuture) - Xcor(ID, Tnow)), 2) +
-                    pow((Ycor(ID, Tfuture) - Ycor(ID, Tnow)), 2)) /
-                (_deltaF);
-        } else if((Tpast >= Tfirst[ID]) && (Tfuture > Tlast[ID])) {
-            v = _fps * CMtoM *
-                sqrt(
-                    pow((Xcor(ID, Tnow) - Xcor(ID, Tpast)), 2) +
-                    pow((Ycor(ID, Tnow) - Ycor(ID, Tpast)), 2)) /
-                (_deltaF); // two dimensional velocity
+    // frames with data deltaF frames before and after use the central difference, which is
+    // calculated directly on the coordinates if the direction is the same for all frames
+    int centralBegin = end;
+    int centralEnd   = end;
+    if(_vComponent != "F" && _firstFrame[ID] >= first && _lastFrame[ID] < end) {
+        centralBegin = std::clamp(_firstFrame[ID] + _deltaF, first, end);
+        centralEnd   = std::clamp(_lastFrame[ID] - _deltaF + 1, centralBegin, end);
+    }
+    for(int frame = first; frame < end; frame++) {
+        if(frame == centralBegin) {
+            frame = centralEnd;
+            if(frame == end) {
+                break;
+            }
         }
+        v[frame - first] = GetInstantaneousVelocity1(
+            frame, frame - _deltaF, frame + _deltaF, ID, _firstFrame, _lastFrame, _xCor, _yCor);
     }
 
-    return v;
+    const int n       = centralEnd - centralBegin;
+    const int begin   = centralBegin - first;
+    const double * x  = _xCor.Span(ID);
+    const double * y  = _yCor.Span(ID);
+    const int deltaF  = _deltaF;
+    const double unit = _fps * CMtoM;
+    const MovementDirection & direction = _directions[0];
+    if(direction.both) {
+        for(int i = begin; i < begin + n; i++) {
+            v[i] = unit *
+                   sqrt(
+                       pow((x[i + deltaF] - x[i - deltaF]), 2) +
+                       pow((y[i + deltaF] - y[i - deltaF]), 2)) /
+                   (2.0 * deltaF); // two dimensional velocity
+        }
+        return;
+    }
+    for(int i = begin; i < begin + n; i++) {
+        v[i] = unit *
+               ((x[i + deltaF] - x[i - deltaF]) * direction.cosAlpha +
+                (y[i + deltaF] - y[i - deltaF]) * direction.sinAlpha) /
+               (2.0 * deltaF);
+    }
+    if(_IgnoreBackwardMovement) {
+        // if no move back and pedestrian moves back, his velocity is set as 0
+        for(int i = begin; i < begin + n; i++) {
+            v[i] = v[i] < 0 ? 0 : v[i];
+        }
+    }
 }
 
-void PedData::CreateGlobalVariables(int numPeds, int numFrames)
+void PedData::CreateGlobalVariables(const vector<int> & firstFrame, const vector<int> & numFrames)
 {
-    LOG_INFO("Enter CreateGlobalVariables with numPeds={} and numFrames={}", numPeds, numFrames);
-    LOG_INFO("allocate memory for xCor");
-    _xCor = ub::matrix<double>(numPeds, numFrames);
-    LOG_INFO("allocate memory for yCor");
-    _yCor = ub::matrix<double>(numPeds, numFrames);
-    LOG_INFO("allocate memory for zCor");
-    _zCor = ub::matrix<double>(numPeds, numFrames);
-    LOG_INFO("allocate memory for index");
-    _id = ub::matrix<double>(numPeds, numFrames);
-    LOG_INFO("allocate memory for vComp");
-    _vComp = ub::matrix<std::string>(numPeds, numFrames);
-    LOG_INFO("allocate memory for firstFrame");
-    _firstFrame = std::vector<int>(numPeds, std::numeric_limits<int>::max());
-    LOG_INFO("allocate memory for lastFrame");
-    _lastFrame = std::vector<int>(numPeds, std::numeric_limits<int>::max());
-    LOG_INFO("Finished memory allocation");
-    for(int i = 0; i < numPeds; i++) {
-        for(int j = 0; j < numFrames; j++) {
-            _xCor(i, j)  = 0;
-            _yCor(i, j)  = 0;
-            _zCor(i, j)  = 0;
-            _vComp(i, j) = "B";
-        }
+    LOG_INFO("Enter CreateGlobalVariables with numPeds={}", firstFrame.size());
+    _xCor = TrajectoryMatrix<double>(firstFrame, numFrames);
+    _yCor = TrajectoryMatrix<double>(firstFrame, numFrames);
+    _zCor = TrajectoryMatrix<double>(firstFrame, numFrames);
+    _directions.clear();
+    _directionIndex.clear();
+    if(_vComponent == "F") {
+        // frames without direction in the file use both components
+        GetDirectionIndex("B");
+        _vComp = TrajectoryMatrix<std::uint32_t>(firstFrame, numFrames, 0);
+    } else {
+        GetDirectionIndex(_vComponent);
+        _vComp = TrajectoryMatrix<std::uint32_t>();
     }
-    LOG_INFO("Leave CreateGlobalVariables()");
+    _firstFrame = std::vector<int>(firstFrame.size(), std::numeric_limits<int>::max());
+    _lastFrame  = std::vector<int>(firstFrame.size(), std::numeric_limits<int>::max());
+    LOG_INFO("Allocated {} values per coordinate", _xCor.NumValues());
 }
 
 
@@ -661,35 +1214,40 @@ fs::path PedData::GetTrajName() const
     return _trajName;
 }
 
-map<int, vector<int>> PedData::GetPedIDsByFrameNr() const
+const FrameIndex & PedData::GetPedIDsByFrameNr() const
 {
     return _pedIDsByFrameNr;
 }
 
-ub::matrix<double> PedData::GetXCor() const
+const TrajectoryMatrix<double> & PedData::GetXCor() const
 {
     return _xCor;
 }
-ub::matrix<double> PedData::GetYCor() const
+const TrajectoryMatrix<double> & PedData::GetYCor() const
 {
     return _yCor;
 }
 
-ub::matrix<double> PedData::GetZCor() const
+const TrajectoryMatrix<double> & PedData::GetZCor() const
 {
     return _zCor;
 }
 
-std::vector<int> PedData::GetFirstFrame() const
+const std::vector<int> & PedData::GetFirstFrame() const
 {
     return _firstFrame;
 }
 
-std::vector<int> PedData::GetLastFrame() const
+const std::vector<int> & PedData::GetLastFrame() const
 {
     return _lastFrame;
 }
 
+const CumulativeDistance & PedData::GetCumulativeDistance() const
+{
+    return _distance;
+}
+
 fs::path PedData::GetProjectRootDir() const
 {
     return _projectRootDir;
@@ -30,16 +30,15 @@
 #define PEDDATA_H_
 
 #include "../general/Macros.h"
+#include "TrajectoryStore.h"
 #include "tinyxml.h"
 
 #include <algorithm> // std::min_element, std::max_element
 #include <boost/algorithm/string.hpp>
-#include <boost/numeric/ublas/io.hpp>
-#include <boost/numeric/ublas/matrix.hpp>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
-namespace ub = boost::numeric::ublas;
 
 #include <filesystem>
 
@@ -61,24 +60,28 @@ public:
     float GetFps() const;
     fs::path GetTrajName() const;
     fs::path GetProjectRootDir() const;
-    std::map<int, std::vector<int>> GetPedIDsByFrameNr() const;
-    ub::matrix<double> GetXCor() const;
-    ub::matrix<double> GetYCor() const;
-    ub::matrix<double> GetZCor() const;
-    ub::matrix<double> GetId() const;
-    std::vector<int> GetFirstFrame() const;
-    std::vector<int> GetLastFrame() const;
-    std::vector<int> GetIndexInFrame(int frame, const std::vector<int> & ids, double zPos) const;
-    std::vector<int> GetIdInFrame(int frame, const std::vector<int> & ids) const;
-    std::vector<int> GetIdInFrame(int frame, const std::vector<int> & ids, double zPos) const;
+    /// positions of the pedestrians (see GetId) in each frame
+    const FrameIndex & GetPedIDsByFrameNr() const;
+    const TrajectoryMatrix<double> & GetXCor() const;
+    const TrajectoryMatrix<double> & GetYCor() const;
+    const TrajectoryMatrix<double> & GetZCor() const;
+    const std::vector<int> & GetFirstFrame() const;
+    const std::vector<int> & GetLastFrame() const;
+    /// distance travelled by each pedestrian, for distances between two frames in constant time
+    const CumulativeDistance & GetCumulativeDistance() const;
+    /// the pedestrian is at the height zPos (in m) in the frame, always true if zPos is None
+    bool IsAtHeight(int id, int frame, double zPos) const;
+    std::vector<int> GetIndexInFrame(int frame, IndexRange ids, double zPos) const;
+    std::vector<int> GetIdInFrame(int frame, IndexRange ids) const;
+    std::vector<int> GetIdInFrame(int frame, IndexRange ids, double zPos) const;
     int GetId(int frame, int id) const;
-    std::vector<double> GetXInFrame(int frame, const std::vector<int> & ids, double zPos) const;
-    std::vector<double> GetYInFrame(int frame, const std::vector<int> & ids, double zPos) const;
-    std::vector<double> GetXInFrame(int frame, const std::vector<int> & ids) const;
-    std::vector<double> GetYInFrame(int frame, const std::vector<int> & ids) const;
-    std::vector<double> GetZInFrame(int frame, const std::vector<int> & ids) const;
-    std::vector<double> GetZInFrame(int frame, const std::vector<int> & ids, double zPos) const;
-    std::vector<double> GetVInFrame(int frame, const std::vector<int> & ids, double zPos) const;
+    std::vector<double> GetXInFrame(int frame, IndexRange ids, double zPos) const;
+    std::vector<double> GetYInFrame(int frame, IndexRange ids, double zPos) const;
+    std::vector<double> GetXInFrame(int frame, IndexRange ids) const;
+    std::vector<double> GetYInFrame(int frame, IndexRange ids) const;
+    std::vector<double> GetZInFrame(int frame, IndexRange ids) const;
+    std::vector<double> GetZInFrame(int frame, IndexRange ids, double zPos) const;
+    std::vector<double> GetVInFrame(int frame, IndexRange ids, double zPos) const;
     bool ReadData(
         const fs::path & projectRootDir,
         const fs::path & outputDir,
@@ -89,20 +92,34 @@ public:
         std::string vComponent,
         const bool IgnoreBackwardMovement);
     fs::path GetOutputLocation() const;
+    /**
+     * Calculates the instantaneous velocity of all pedestrians in all frames once, GetVInFrame
+     * serves the values from this column afterwards. The parameters of the velocity are fixed by
+     * ReadData, so the column is only calculated once.
+     */
+    void PrecomputeVelocities();
 
 
 private:
     bool InitializeVariables(const fs::path & filename);
-    void CreateGlobalVariables(int numPeds, int numFrames);
-    double GetInstantaneousVelocity(
-        int Tnow,
-        int Tpast,
-        int Tfuture,
-        int ID,
-        const std::vector<int> & Tfirst,
-        const std::vector<int> & Tlast,
-        const ub::matrix<double> & Xcor,
-        const ub::matrix<double> & Ycor) const;
+    /**
+     * Reads the data from the binary cache (.jpsbin) next to the trajectory file.
+     * @return false if there is no cache or it does not match the trajectory file
+     */
+    bool ReadBinaryCache(const fs::path & source);
+    /**
+     * Writes the data to the binary cache (.jpsbin) next to the trajectory file. Failures are
+     * reported as warnings only, the cache is optional.
+     */
+    void WriteBinaryCache(const fs::path & source) const;
+    /**
+     * allocates the per pedestrian storage
+     * @param firstFrame first frame with data of each pedestrian
+     * @param numFrames number of frames from firstFrame to the last frame with data
+     */
+    void CreateGlobalVariables(
+        const std::vector<int> & firstFrame,
+        const std::vector<int> & numFrames);
     double GetInstantaneousVelocity1(
         int Tnow,
         int Tpast,
@@ -110,8 +127,26 @@ private:
         int ID,
         const std::vector<int> & Tfirst,
         const std::vector<int> & Tlast,
-        const ub::matrix<double> & Xcor,
-        const ub::matrix<double> & Ycor) const;
+        const TrajectoryMatrix<double> & Xcor,
+        const TrajectoryMatrix<double> & Ycor) const;
+
+    /// Movement direction used to calculate the instantaneous velocity
+    struct MovementDirection {
+        bool both       = true; // magnitude of the velocity in x and y ("B")
+        double cosAlpha = 1;    // direction of the velocity component if not both
+        double sinAlpha = 0;
+    };
+
+    /**
+     * Converts the direction given in the ini or trajectory file ("B", "X+", "Y+", "X-", "Y-" or an
+     * angle from 0 to 360)
+     */
+    static MovementDirection ParseMovementDirection(const std::string & vcmp);
+    /// Index of the movement direction in _directions
+    std::uint32_t GetDirectionIndex(const std::string & vcmp);
+    const MovementDirection & GetMovementDirection(int ID, int frame) const;
+    /// Fills the velocity column over the span of the pedestrian
+    void FillVelocities(int ID);
 
 private:
     fs::path _trajName;
@@ -123,7 +158,7 @@ private:
     int _numFrames           = 0; // total number of frames
     int _numPeds             = 0; // total number of pedestrians
     float _fps               = 16;
-    std::map<int, std::vector<int>> _pedIDsByFrameNr;
+    FrameIndex _pedIDsByFrameNr; // position of the pedestrians (in _pedIds) in each frame
 
     int _deltaF                  = 5;
     std::string _vComponent      = "B";
@@ -131,11 +166,20 @@ private:
 
     std::vector<int> _firstFrame; // Record the first frame of each pedestrian
     std::vector<int> _lastFrame;  // Record the last frame of each pedestrian
-    ub::matrix<double> _xCor;
-    ub::matrix<double> _yCor;
-    ub::matrix<double> _zCor;
-    ub::matrix<double> _id;
-    ub::matrix<std::string> _vComp;
+    std::vector<int> _pedIds;     // ID in the trajectory file of each pedestrian
+    TrajectoryMatrix<double> _xCor;
+    TrajectoryMatrix<double> _yCor;
+    TrajectoryMatrix<double> _zCor;
+    CumulativeDistance _distance; // in m
+    // Distinct movement directions, the first one is given by _vComponent ("B" if the direction
+    // is read from the trajectory file)
+    std::vector<MovementDirection> _directions;
+    std::map<std::string, std::uint32_t> _directionIndex;
+    // Index in _directions for each frame, only filled if the direction is given in the file
+    TrajectoryMatrix<std::uint32_t> _vComp;
+    // Instantaneous velocity of each frame, only valid after PrecomputeVelocities
+    TrajectoryMatrix<double> _velocity;
+    bool _velocityValid = false;
 };
 
 #endif /* PEDDATA_H_ */
@@ -0,0 +1,42 @@
+#include "PolygonIndex.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace bgi = boost::geometry::index;
+
+namespace
+{
+using Box   = boost::geometry::model::box<point_2d>;
+using Entry = std::pair<Box, std::size_t>;
+
+std::vector<Entry> Envelopes(const polygon_list & polygons)
+{
+    std::vector<Entry> entries;
+    entries.reserve(polygons.size());
+    for(std::size_t i = 0; i < polygons.size(); i++) {
+        entries.emplace_back(boost::geometry::return_envelope<Box>(polygons[i]), i);
+    }
+    return entries;
+}
+} // namespace
+
+// the range constructor packs the tree, which is faster to build and to query than inserting
+PolygonIndex::PolygonIndex(const polygon_list & polygons) :
+    _polygons(polygons), _tree(Envelopes(polygons))
+{
+}
+
+void PolygonIndex::Query(const polygon_2d & area, std::vector<std::size_t> & candidates) const
+{
+    thread_local std::vector<Entry> hits;
+    hits.clear();
+    _tree.query(
+        bgi::intersects(boost::geometry::return_envelope<Box>(area)), std::back_inserter(hits));
+    candidates.clear();
+    for(const Entry & hit : hits) {
+        candidates.push_back(hit.second);
+    }
+    // results are summed up and written in the order of the polygons
+    std::sort(candidates.begin(), candidates.end());
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../general/Macros.h"
+
+#include <boost/geometry/index/rtree.hpp>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Polygons (e.g. the Voronoi cells of a frame) together with an R-tree of their envelopes.
+ *
+ * Only polygons whose envelope overlaps the envelope of an area can intersect the area, so the
+ * exact intersection is needed for the candidates returned by Query only.
+ */
+class PolygonIndex
+{
+public:
+    /// the polygons have to outlive the index
+    explicit PolygonIndex(const polygon_list & polygons);
+
+    const polygon_list & Polygons() const { return _polygons; }
+
+    /// indices of the polygons whose envelope intersects the envelope of area in ascending order
+    void Query(const polygon_2d & area, std::vector<std::size_t> & candidates) const;
+
+private:
+    using Box   = boost::geometry::model::box<point_2d>;
+    using Entry = std::pair<Box, std::size_t>;
+
+    const polygon_list & _polygons;
+    boost::geometry::index::rtree<Entry, boost::geometry::index::quadratic<16>> _tree;
+};
@@ -0,0 +1,239 @@
+#include "ProfileGrid.h"
+
+#include "PedData.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+/// Sutherland-Hodgman step for the half plane x >= bound (keepRight) or x <= bound
+void ClipX(
+    const std::vector<point_2d> & input,
+    std::vector<point_2d> & output,
+    double bound,
+    bool keepRight)
+{
+    output.clear();
+    if(input.empty()) {
+        return;
+    }
+    auto inside = [&](const point_2d & p) { return keepRight ? p.x() >= bound : p.x() <= bound; };
+    const point_2d * previous = &input.back();
+    bool previousInside       = inside(*previous);
+    for(const point_2d & current : input) {
+        const bool currentInside = inside(current);
+        if(currentInside != previousInside) {
+            const double t = (bound - previous->x()) / (current.x() - previous->x());
+            output.emplace_back(bound, previous->y() + t * (current.y() - previous->y()));
+        }
+        if(currentInside) {
+            output.push_back(current);
+        }
+        previous       = &current;
+        previousInside = currentInside;
+    }
+}
+
+/**
+ * Adds the area of the polygon (open ring) inside the horizontal band [bottoms[k], tops[k]] to
+ * areas[k] for all bands.
+ *
+ * Each edge contributes the signed area of the trapezoid between the edge, clamped to the band,
+ * and the lower side of the band. Summed up over the closed ring this is the exact covered area,
+ * also for non-convex polygons; the sign is positive for clockwise and negative for counter
+ * clockwise rings. The loop over the bands has no branches and is vectorized by the compiler.
+ */
+void AddBandAreas(
+    const std::vector<point_2d> & polygon,
+    const double * tops,
+    const double * bottoms,
+    int numBands,
+    double * areas)
+{
+    for(std::size_t e = 0; e < polygon.size(); e++) {
+        const point_2d & p = polygon[e];
+        const point_2d & q = polygon[(e + 1) % polygon.size()];
+        const double dx    = q.x() - p.x();
+        if(dx == 0) {
+            continue;
+        }
+        const double y0 = p.y();
+        const double y1 = q.y();
+        if(y0 == y1) {
+            for(int k = 0; k < numBands; k++) {
+                areas[k] += dx * (std::min(std::max(y0, bottoms[k]), tops[k]) - bottoms[k]);
+            }
+            continue;
+        }
+        // integral of (clamp(y) - bottom) over the edge, with y linear in x
+        const double slope = dx / (y1 - y0);
+        for(int k = 0; k < numBands; k++) {
+            const double top    = tops[k];
+            const double bottom = bottoms[k];
+            const double c0     = std::min(std::max(y0, bottom), top);
+            const double c1     = std::min(std::max(y1, bottom), top);
+            const double a0     = std::max(y0 - top, 0.0);
+            const double a1     = std::max(y1 - top, 0.0);
+            areas[k] +=
+                slope * ((c1 - c0) * (0.5 * (c0 + c1) - bottom) + (top - bottom) * (a1 - a0));
+        }
+    }
+}
+} // namespace
+
+ProfileGrid::ProfileGrid(
+    double minX,
+    double maxY,
+    double sizeX,
+    double sizeY,
+    int numRows,
+    int numColumns) :
+    _minX(minX),
+    _maxY(maxY),
+    _sizeX(sizeX),
+    _sizeY(sizeY),
+    _numRows(numRows),
+    _numColumns(numColumns),
+    _density(numRows * numColumns, 0),
+    _weightedVelocity(numRows * numColumns, 0),
+    _velocity(numRows * numColumns, 0),
+    _count(numRows * numColumns, 0)
+{
+    _tops.reserve(numRows);
+    _bottoms.reserve(numRows);
+    for(int row = 0; row < numRows; row++) {
+        _tops.push_back(Top(row));
+        _bottoms.push_back(Bottom(row));
+    }
+}
+
+void ProfileGrid::Add(const polygon_2d & cell, double velocity)
+{
+    const auto & ring = cell.outer();
+    if(ring.size() < 3 || _numRows <= 0 || _numColumns <= 0) {
+        return;
+    }
+    // obstacles in the geometry are holes of the cells, their area does not belong to the cell
+    const double cellArea = std::fabs(boost::geometry::area(cell));
+    if(cellArea <= 0) {
+        return;
+    }
+    thread_local std::vector<point_2d> points;
+    thread_local std::vector<point_2d> left;
+    thread_local std::vector<point_2d> column;
+    thread_local std::vector<double> areas;
+    thread_local std::vector<point_2d> hole;
+    thread_local std::vector<double> holeAreas;
+    // open ring, the closing point would only add a zero length edge
+    points.assign(ring.begin(), ring.end() - 1);
+
+    double minX = points[0].x(), maxX = points[0].x();
+    double minY = points[0].y(), maxY = points[0].y();
+    for(const point_2d & p : points) {
+        minX = std::min(minX, p.x());
+        maxX = std::max(maxX, p.x());
+        minY = std::min(minY, p.y());
+        maxY = std::max(maxY, p.y());
+    }
+    // one grid cell more on each side covers rounding of the grid coordinates
+    const int firstColumn = std::max(0, (int) std::floor((minX - _minX) / _sizeX) - 1);
+    const int lastColumn  = std::min(_numColumns - 1, (int) std::floor((maxX - _minX) / _sizeX) + 1);
+    const int firstRow    = std::max(0, (int) std::floor((_maxY - maxY) / _sizeY) - 1);
+    const int lastRow     = std::min(_numRows - 1, (int) std::floor((_maxY - minY) / _sizeY) + 1);
+
+    if(lastRow < firstRow) {
+        return;
+    }
+    const int numBands = lastRow - firstRow + 1;
+
+    for(int j = firstColumn; j <= lastColumn; j++) {
+        ClipX(points, left, Left(j), true);
+        ClipX(left, column, Right(j), false);
+        if(column.size() < 3) {
+            continue;
+        }
+        areas.assign(numBands, 0);
+        AddBandAreas(column, &_tops[firstRow], &_bottoms[firstRow], numBands, areas.data());
+        holeAreas.assign(numBands, 0);
+        for(const auto & inner : cell.inners()) {
+            if(inner.size() < 4) {
+                continue;
+            }
+            hole.assign(inner.begin(), inner.end() - 1);
+            ClipX(hole, left, Left(j), true);
+            ClipX(left, column, Right(j), false);
+            if(column.size() >= 3) {
+                AddBandAreas(
+                    column, &_tops[firstRow], &_bottoms[firstRow], numBands, holeAreas.data());
+            }
+        }
+        for(int i = firstRow; i <= lastRow; i++) {
+            // the rings of the holes run in the opposite direction of the outer ring
+            const double partArea =
+                std::fabs(areas[i - firstRow]) - std::fabs(holeAreas[i - firstRow]);
+            // cells which only touch the grid cell do not count
+            if(partArea <= 1e-12 * cellArea) {
+                continue;
+            }
+            const std::size_t index = i * _numColumns + j;
+            _density[index] += partArea / cellArea;
+            _weightedVelocity[index] += velocity * partArea;
+            _velocity[index] += velocity;
+            _count[index]++;
+        }
+    }
+}
+
+double ProfileGrid::CellArea(int row, int column) const
+{
+    return (Right(column) - Left(column)) * (Top(row) - Bottom(row));
+}
+
+double ProfileGrid::Density(int row, int column) const
+{
+    return _density[row * _numColumns + column] / (CellArea(row, column) * CMtoM * CMtoM);
+}
+
+double ProfileGrid::VoronoiVelocity(int row, int column) const
+{
+    return _weightedVelocity[row * _numColumns + column] / CellArea(row, column);
+}
+
+double ProfileGrid::ArithmeticVelocity(int row, int column) const
+{
+    const std::size_t index = row * _numColumns + column;
+    return _count[index] == 0 ? 0 : _velocity[index] / _count[index];
+}
+
+void ProfileWindow::Add(const std::vector<double> & values)
+{
+    if(_numFrames == 0) {
+        _mean.assign(values.size(), 0);
+        _m2.assign(values.size(), 0);
+    }
+    _numFrames++;
+    for(std::size_t i = 0; i < values.size(); i++) {
+        const double delta = values[i] - _mean[i];
+        _mean[i] += delta / _numFrames;
+        _m2[i] += delta * (values[i] - _mean[i]);
+    }
+}
+
+void ProfileWindow::Clear()
+{
+    _numFrames = 0;
+    _mean.clear();
+    _m2.clear();
+}
+
+std::vector<double> ProfileWindow::Variance() const
+{
+    std::vector<double> variance(_m2.size(), 0);
+    if(_numFrames > 0) {
+        for(std::size_t i = 0; i < _m2.size(); i++) {
+            variance[i] = _m2[i] / _numFrames;
+        }
+    }
+    return variance;
+}
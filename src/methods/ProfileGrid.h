@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../general/Macros.h"
+
+#include <vector>
+
+/**
+ * Raster of the density and velocity profiles of Method D.
+ *
+ * The grid starts at the upper left corner (minX, maxY) of the geometry, row 0 is the top row.
+ * Each Voronoi cell only visits the grid cells its bounding box touches: it is clipped to each
+ * column strip, and the covered area of all rows of the strip is calculated at once with exact
+ * trapezoid coverage. Holes of the cells (obstacles) are subtracted the same way. The parts are
+ * accumulated in all grid cells of the raster.
+ */
+class ProfileGrid
+{
+public:
+    ProfileGrid(double minX, double maxY, double sizeX, double sizeY, int numRows, int numColumns);
+
+    int NumRows() const { return _numRows; }
+    int NumColumns() const { return _numColumns; }
+
+    /// adds the parts of the Voronoi cell of a pedestrian with the given velocity
+    void Add(const polygon_2d & cell, double velocity);
+
+    /// Voronoi density (1/m^2) in the grid cell
+    double Density(int row, int column) const;
+    /// mean velocity in the grid cell weighted with the area of the Voronoi cells in it
+    double VoronoiVelocity(int row, int column) const;
+    /// arithmetic mean of the velocities of the Voronoi cells intersecting the grid cell
+    double ArithmeticVelocity(int row, int column) const;
+
+private:
+    double Left(int column) const { return _minX + column * _sizeX; }
+    double Right(int column) const { return _minX + column * _sizeX + _sizeX; }
+    double Top(int row) const { return _maxY - row * _sizeY; }
+    double Bottom(int row) const { return _maxY - row * _sizeY - _sizeY; }
+    double CellArea(int row, int column) const;
+
+    double _minX;
+    double _maxY;
+    double _sizeX;
+    double _sizeY;
+    int _numRows;
+    int _numColumns;
+    std::vector<double> _tops;
+    std::vector<double> _bottoms;
+
+    // sums over the Voronoi cells per grid cell, row major
+    std::vector<double> _density;
+    std::vector<double> _weightedVelocity;
+    std::vector<double> _velocity;
+    std::vector<int> _count;
+};
+
+/// Mean and variance of each grid cell of the profiles of consecutive frames
+class ProfileWindow
+{
+public:
+    void Add(const std::vector<double> & values);
+    void Clear();
+
+    int NumFrames() const { return _numFrames; }
+    const std::vector<double> & Mean() const { return _mean; }
+    /// population variance of each grid cell over the frames
+    std::vector<double> Variance() const;
+
+private:
+    int _numFrames = 0;
+    std::vector<double> _mean;
+    // sum of the squared differences to the mean (Welford's algorithm)
+    std::vector<double> _m2;
+};
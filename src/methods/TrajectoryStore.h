@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * Per pedestrian values over the frames in which the pedestrian is present.
+ *
+ * The values of pedestrian i are stored contiguously for the frames
+ * [FirstFrame(i), FirstFrame(i) + NumFrames(i)). Reading a frame outside of this span returns a
+ * default constructed value, like reading a dense numPeds x numFrames matrix filled with zeros.
+ */
+template <typename T>
+class TrajectoryMatrix
+{
+public:
+    TrajectoryMatrix() = default;
+
+    /**
+     * @param firstFrame first frame of the span of each pedestrian
+     * @param numFrames number of frames in the span of each pedestrian
+     * @param value initial value of all frames in the spans
+     */
+    TrajectoryMatrix(
+        const std::vector<int> & firstFrame,
+        const std::vector<int> & numFrames,
+        const T & value = T()) :
+        _firstFrame(firstFrame), _numFrames(numFrames), _offset(firstFrame.size() + 1, 0)
+    {
+        assert(firstFrame.size() == numFrames.size());
+        for(std::size_t i = 0; i < numFrames.size(); i++) {
+            _offset[i + 1] = _offset[i] + numFrames[i];
+        }
+        _values.assign(_offset.back(), value);
+    }
+
+    int NumPeds() const { return (int) _firstFrame.size(); }
+    int FirstFrame(int ped) const { return _firstFrame[ped]; }
+    int NumFrames(int ped) const { return _numFrames[ped]; }
+    std::size_t NumValues() const { return _values.size(); }
+
+    bool Contains(int ped, int frame) const
+    {
+        return frame >= _firstFrame[ped] && frame - _firstFrame[ped] < _numFrames[ped];
+    }
+
+    T operator()(int ped, int frame) const
+    {
+        return Contains(ped, frame) ? _values[_offset[ped] + (frame - _firstFrame[ped])] : T();
+    }
+
+    /// Value of a frame within the span of the pedestrian
+    T & Ref(int ped, int frame)
+    {
+        assert(Contains(ped, frame));
+        return _values[_offset[ped] + (frame - _firstFrame[ped])];
+    }
+
+    /// Values of the span of the pedestrian, starting at FirstFrame(ped)
+    const T * Span(int ped) const { return _values.data() + _offset[ped]; }
+    T * Span(int ped) { return _values.data() + _offset[ped]; }
+
+private:
+    std::vector<int> _firstFrame;
+    std::vector<int> _numFrames;
+    std::vector<std::size_t> _offset;
+    std::vector<T> _values;
+};
+
+/// Non-owning read-only view of a TrajectoryMatrix, the matrix has to outlive the view
+template <typename T>
+class TrajectoryView
+{
+public:
+    TrajectoryView() = default;
+    TrajectoryView(const TrajectoryMatrix<T> & matrix) : _matrix(&matrix) {}
+
+    int NumPeds() const { return _matrix->NumPeds(); }
+    int FirstFrame(int ped) const { return _matrix->FirstFrame(ped); }
+    int NumFrames(int ped) const { return _matrix->NumFrames(ped); }
+    bool Contains(int ped, int frame) const { return _matrix->Contains(ped, frame); }
+    T operator()(int ped, int frame) const { return (*_matrix)(ped, frame); }
+    const T * Span(int ped) const { return _matrix->Span(ped); }
+
+private:
+    const TrajectoryMatrix<T> * _matrix = nullptr;
+};
+
+/**
+ * Distance travelled by each pedestrian from the first frame of the recording up to each frame.
+ *
+ * The distance between two frames is the difference of two values. Like summing up the segments
+ * of the trajectory, positions outside of the span of a pedestrian count as (0, 0).
+ */
+class CumulativeDistance
+{
+public:
+    CumulativeDistance() = default;
+
+    /**
+     * @param xCor x coordinates of the pedestrians
+     * @param yCor y coordinates of the pedestrians
+     * @param unit factor applied to each segment length, e.g. to convert cm to m
+     */
+    CumulativeDistance(TrajectoryView<double> xCor, TrajectoryView<double> yCor, double unit)
+    {
+        const int numPeds = xCor.NumPeds();
+        std::vector<int> firstFrame(numPeds);
+        std::vector<int> numFrames(numPeds);
+        for(int ped = 0; ped < numPeds; ped++) {
+            firstFrame[ped] = xCor.FirstFrame(ped);
+            numFrames[ped]  = xCor.NumFrames(ped) + 1; // including the step out of the span
+        }
+        _distance = TrajectoryMatrix<double>(firstFrame, numFrames);
+        for(int ped = 0; ped < numPeds; ped++) {
+            const int first   = firstFrame[ped];
+            const double * x  = xCor.Span(ped);
+            const double * y  = yCor.Span(ped);
+            double * distance = _distance.Span(ped);
+            double totalDist  = 0;
+            double previousX  = 0;
+            double previousY  = 0;
+            for(int i = 0; i < numFrames[ped]; i++) {
+                const double currentX = i + 1 < numFrames[ped] ? x[i] : 0;
+                const double currentY = i + 1 < numFrames[ped] ? y[i] : 0;
+                if(first + i > 0) {
+                    double dxq = (previousX - currentX) * (previousX - currentX);
+                    double dyq = (previousY - currentY) * (previousY - currentY);
+                    totalDist += sqrt(dxq + dyq) * unit;
+                }
+                distance[i] = totalDist;
+                previousX   = currentX;
+                previousY   = currentY;
+            }
+        }
+    }
+
+    /// distance travelled by the pedestrian from firstFrame to lastFrame
+    double Between(int ped, int firstFrame, int lastFrame) const
+    {
+        if(lastFrame <= firstFrame) {
+            return 0;
+        }
+        return At(ped, lastFrame) - At(ped, firstFrame);
+    }
+
+private:
+    double At(int ped, int frame) const
+    {
+        if(frame < _distance.FirstFrame(ped)) {
+            return 0;
+        }
+        const int i = std::min(frame - _distance.FirstFrame(ped), _distance.NumFrames(ped) - 1);
+        return _distance.Span(ped)[i];
+    }
+
+    TrajectoryMatrix<double> _distance;
+};
+
+/// Non-owning read-only range of values, e.g. pedestrian indices
+template <typename T>
+class ConstSpan
+{
+public:
+    ConstSpan() = default;
+    ConstSpan(const T * begin, const T * end) : _begin(begin), _end(end) {}
+    ConstSpan(const std::vector<T> & values) :
+        _begin(values.data()), _end(values.data() + values.size())
+    {
+    }
+
+    const T * begin() const { return _begin; }
+    const T * end() const { return _end; }
+    std::size_t size() const { return _end - _begin; }
+    bool empty() const { return _begin == _end; }
+    const T & operator[](std::size_t i) const { return _begin[i]; }
+
+private:
+    const T * _begin = nullptr;
+    const T * _end   = nullptr;
+};
+
+/// Non-owning range of pedestrian indices
+using IndexRange = ConstSpan<int>;
+
+/**
+ * Indices of the pedestrians present in each frame in compressed sparse row layout. The order of
+ * the pedestrians within a frame is the order of the trajectory file.
+ */
+class FrameIndex
+{
+public:
+    FrameIndex() = default;
+
+    /**
+     * @param offsets position of the first pedestrian of each frame in indices, numFrames + 1
+     * entries
+     * @param indices pedestrian indices of all frames
+     */
+    FrameIndex(std::vector<std::int64_t> offsets, std::vector<int> indices) :
+        _offsets(std::move(offsets)), _indices(std::move(indices))
+    {
+    }
+
+    int NumFrames() const { return _offsets.empty() ? 0 : (int) _offsets.size() - 1; }
+
+    /// pedestrians in the frame, empty for frames outside of the recording
+    IndexRange operator[](int frame) const
+    {
+        if(frame < 0 || frame >= NumFrames()) {
+            return {};
+        }
+        return {_indices.data() + _offsets[frame], _indices.data() + _offsets[frame + 1]};
+    }
+
+    const std::vector<std::int64_t> & Offsets() const { return _offsets; }
+    const std::vector<int> & Indices() const { return _indices; }
+
+private:
+    std::vector<std::int64_t> _offsets;
+    std::vector<int> _indices;
+};
+
+/// Non-owning read-only view of a FrameIndex, the index has to outlive the view
+class FrameIndexView
+{
+public:
+    FrameIndexView() = default;
+    FrameIndexView(const FrameIndex & index) : _index(&index) {}
+
+    int NumFrames() const { return _index->NumFrames(); }
+    IndexRange operator[](int frame) const { return (*_index)[frame]; }
+
+private:
+    const FrameIndex * _index = nullptr;
+};
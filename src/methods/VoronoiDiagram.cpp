@@ -30,7 +30,12 @@
 
 #include "VoronoiDiagram.h"
 
+#include "ConvexClipper.h"
+
+#include <algorithm>
 #include <iostream>
+#include <numeric>
+#include <tuple>
 
 
 using namespace std;
@@ -40,20 +45,39 @@ VoronoiDiagram::VoronoiDiagram() {}
 
 VoronoiDiagram::~VoronoiDiagram() {}
 
+void VoronoiDiagram::clear()
+{
+    points.clear();
+    velocities.clear();
+    ids.clear();
+    firstAtSite.clear();
+    siteOrder.clear();
+    cells.clear();
+    builder.clear();
+    diagram.clear();
+}
+
+void VoronoiDiagram::reserve(std::size_t numSites)
+{
+    points.reserve(numSites);
+    velocities.reserve(numSites);
+    ids.reserve(numSites);
+    firstAtSite.reserve(numSites);
+    siteOrder.reserve(numSites);
+    cells.reserve(numSites);
+}
+
 // Traversing Voronoi edges using cell iterator.
-std::vector<std::pair<polygon_2d, int>> VoronoiDiagram::getVoronoiPolygons(
+const std::vector<std::pair<polygon_2d, int>> & VoronoiDiagram::getVoronoiPolygons(
     vector<double> & XInFrame,
     vector<double> & YInFrame,
     vector<double> & VInFrame,
     vector<int> & IdInFrame,
     const double Bound_Max)
 {
+    clear();
     double M2CM        = 10000;
     int numPedsInFrame = IdInFrame.size();
-    vector<int> XInFrame_temp;
-    vector<int> YInFrame_temp;
-    vector<double> VInFrame_temp;
-    vector<int> IdInFrame_temp;
     // in case 1 or 2 pedestrians are in the geometry
     // add dummy pedestrians around to enable voronoi calculations
     // @todo: maybe use negative ids for these dummy pedestrians to exclude
@@ -88,33 +112,38 @@ std::vector<std::pair<polygon_2d, int>> VoronoiDiagram::getVoronoiPolygons(
 
     for(int i = 0; i < numPedsInFrame; i++) {
         points.push_back(point_type2(round(XInFrame[i]), round(YInFrame[i])));
-        XInFrame_temp.push_back(round(XInFrame[i]));
-        YInFrame_temp.push_back(round(YInFrame[i]));
-        VInFrame_temp.push_back(VInFrame[i]);
-        IdInFrame_temp.push_back(IdInFrame[i]);
+        velocities.push_back(VInFrame[i]);
+        ids.push_back(IdInFrame[i]);
         // std::cout << "i: " << i << " Id " << IdInFrame[i] << "  pos = " << XInFrame[i] << ", " <<
         // YInFrame[i] << "\n";
     }
 
 
-    VD voronoidiagram;
-    construct_voronoi(points.begin(), points.end(), &voronoidiagram);
-    int Ncell = 0;
-    // std::vector<polygon_2d> polygons;
-    std::vector<std::pair<polygon_2d, int>> polygons_id;
+    // pedestrians at the same (rounded) position share one cell, which belongs to the first of them
+    firstAtSite.resize(numPedsInFrame);
+    std::iota(firstAtSite.begin(), firstAtSite.end(), 0);
+    siteOrder.assign(firstAtSite.begin(), firstAtSite.end());
+    std::sort(siteOrder.begin(), siteOrder.end(), [this](int a, int b) {
+        return std::make_tuple(points[a].x(), points[a].y(), a) <
+               std::make_tuple(points[b].x(), points[b].y(), b);
+    });
+    for(int i = 1; i < numPedsInFrame; i++) {
+        if(points[siteOrder[i]] == points[siteOrder[i - 1]]) {
+            firstAtSite[siteOrder[i]] = firstAtSite[siteOrder[i - 1]];
+        }
+    }
+
+    // same as construct_voronoi, but the builder and the diagram keep their memory between frames
+    boost::polygon::insert(points.begin(), points.end(), &builder);
+    builder.construct(&diagram);
+    int Ncell          = 0;
     double Bd_Box_minX = -Bound_Max;
     double Bd_Box_minY = -Bound_Max;
     double Bd_Box_maxX = Bound_Max;
     double Bd_Box_maxY = Bound_Max;
-    polygon_2d boundingbox;
-    boost::geometry::append(boundingbox, boost::geometry::make<point_2d>(-Bound_Max, -Bound_Max));
-    boost::geometry::append(boundingbox, boost::geometry::make<point_2d>(-Bound_Max, Bound_Max));
-    boost::geometry::append(boundingbox, boost::geometry::make<point_2d>(Bound_Max, Bound_Max));
-    boost::geometry::append(boundingbox, boost::geometry::make<point_2d>(Bound_Max, -Bound_Max));
-    boost::geometry::correct(boundingbox);
-
-    for(voronoi_diagram<double>::const_cell_iterator it = voronoidiagram.cells().begin();
-        it != voronoidiagram.cells().end();
+
+    for(voronoi_diagram<double>::const_cell_iterator it = diagram.cells().begin();
+        it != diagram.cells().end();
         ++it) {
         polygon_2d poly;
         vector<point_type2> polypts;
@@ -124,13 +153,9 @@ std::vector<std::pair<polygon_2d, int>> VoronoiDiagram::getVoronoiPolygons(
         const voronoi_diagram<double>::edge_type * edge = cell.incident_edge();
         point_type2 pt_temp;
         point_type2 thispoint = retrieve_point(*it);
-        for(int k = 0; k < numPedsInFrame; k++) {
-            if(XInFrame_temp[k] == thispoint.x() && YInFrame_temp[k] == thispoint.y()) {
-                VInFrame[Ncell]  = VInFrame_temp[k];
-                IdInFrame[Ncell] = IdInFrame_temp[k];
-                break;
-            }
-        }
+        const int site        = firstAtSite[cell.source_index()];
+        VInFrame[Ncell]       = velocities[site];
+        IdInFrame[Ncell]      = ids[site];
 
         XInFrame[Ncell] = thispoint.x();
         YInFrame[Ncell] = thispoint.y();
@@ -155,11 +180,11 @@ std::vector<std::pair<polygon_2d, int>> VoronoiDiagram::getVoronoiPolygons(
                          (fabs(edge->vertex0()->y()) > Bound_Max)) &&
                         fabs(edge->vertex1()->x()) < Bound_Max &&
                         (fabs(edge->vertex1()->y()) < Bound_Max)) {
-                        pt_s = getIntersectionPoint(
-                            point_2d(edge->vertex0()->x(), edge->vertex0()->y()),
-                            point_2d(edge->vertex1()->x(), edge->vertex1()->y()),
-                            boundingbox);
-                        pt_temp = point_type2(edge->vertex1()->x(), edge->vertex1()->y());
+                        pt_s              = point_type2(edge->vertex0()->x(), edge->vertex0()->y());
+                        pt_temp           = point_type2(edge->vertex1()->x(), edge->vertex1()->y());
+                        point_type2 pt_in = pt_temp;
+                        clip_segment(
+                            pt_s, pt_in, Bd_Box_minX, Bd_Box_minY, Bd_Box_maxX, Bd_Box_maxY);
                         polypts.push_back(point_type2(pt_s.x(), pt_s.y()));
                         NumVertex++;
                         infinite_s = true;
@@ -169,11 +194,11 @@ std::vector<std::pair<polygon_2d, int>> VoronoiDiagram::getVoronoiPolygons(
                         (fabs(edge->vertex1()->x()) > Bound_Max ||
                          (fabs(edge->vertex1()->y()) > Bound_Max))) {
                         polypts.push_back(point_type2(edge->vertex0()->x(), edge->vertex0()->y()));
-                        pt_e = getIntersectionPoint(
-                            point_2d(edge->vertex0()->x(), edge->vertex0()->y()),
-                            point_2d(edge->vertex1()->x(), edge->vertex1()->y()),
-                            boundingbox);
-                        pt_temp = point_type2(edge->vertex0()->x(), edge->vertex0()->y());
+                        pt_temp           = point_type2(edge->vertex0()->x(), edge->vertex0()->y());
+                        pt_e              = point_type2(edge->vertex1()->x(), edge->vertex1()->y());
+                        point_type2 pt_in = pt_temp;
+                        clip_segment(
+                            pt_in, pt_e, Bd_Box_minX, Bd_Box_minY, Bd_Box_maxX, Bd_Box_maxY);
                         polypts.push_back(point_type2(pt_e.x(), pt_e.y()));
                         NumVertex += 2;
                         index_end  = NumVertex;
@@ -226,10 +251,10 @@ std::vector<std::pair<polygon_2d, int>> VoronoiDiagram::getVoronoiPolygons(
         if(id_ped < 0) {
             continue;
         }
-        polygons_id.push_back(poly_id);
+        cells.push_back(poly_id);
         Ncell++;
     } // for voronoi cells
-    return polygons_id;
+    return cells;
 }
 
 point_type2 VoronoiDiagram::retrieve_point(const cell_type & cell)
@@ -272,15 +297,8 @@ point_type2 VoronoiDiagram::clip_infinite_edge(
         pt.y(origin.y() + direction.y() * koef);
     }
 
-    polygon_2d boundingbox;
-    boost::geometry::append(boundingbox, boost::geometry::make<point_2d>(minX, minY));
-    boost::geometry::append(boundingbox, boost::geometry::make<point_2d>(minX, maxY));
-    boost::geometry::append(boundingbox, boost::geometry::make<point_2d>(maxX, maxY));
-    boost::geometry::append(boundingbox, boost::geometry::make<point_2d>(maxX, minY));
-    boost::geometry::correct(boundingbox);
-
-    pt = getIntersectionPoint(
-        point_2d(pt.x(), pt.y()), point_2d(origin.x(), origin.y()), boundingbox);
+    // pt is outside of the box, the edge leaves the box between origin and pt
+    clip_segment(origin, pt, minX, minY, maxX, maxY);
     return pt;
 }
 
@@ -419,29 +437,57 @@ vector<point_type2> VoronoiDiagram::add_bounding_points(
 }
 
 
-//-----------In getIntersectionPoint() the edges of the square is  vertical or horizontal
-// segment--------------
-point_type2 VoronoiDiagram::getIntersectionPoint(
-    const point_2d & pt0,
-    const point_2d & pt1,
-    const polygon_2d & square)
+/**
+ * Clips the segment pt0-pt1 to the axis aligned box [minX, maxX] x [minY, maxY] (Liang-Barsky).
+ * Endpoints outside of the box are moved onto its boundary. Returns false if the segment does not
+ * intersect the box, the points are unchanged then.
+ */
+bool VoronoiDiagram::clip_segment(
+    point_type2 & pt0,
+    point_type2 & pt1,
+    double minX,
+    double minY,
+    double maxX,
+    double maxY)
 {
-    vector<point_2d> pt;
-    segment edge0(pt0, pt1);
-    vector<point_2d> const & opoints = square.outer();
-    for(vector<point_2d>::size_type i = 1; i < opoints.size(); ++i) {
-        segment edge1(opoints[i], opoints[i - 1]);
-        if(intersects(edge0, edge1)) {
-            intersection(edge0, edge1, pt);
-            break;
+    const double dx   = pt1.x() - pt0.x();
+    const double dy   = pt1.y() - pt0.y();
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {pt0.x() - minX, maxX - pt0.x(), pt0.y() - minY, maxY - pt0.y()};
+    double t0         = 0;
+    double t1         = 1;
+    for(int i = 0; i < 4; i++) {
+        if(p[i] == 0) {
+            // parallel to this side of the box
+            if(q[i] < 0) {
+                return false;
+            }
+            continue;
+        }
+        const double t = q[i] / p[i];
+        if(p[i] < 0) {
+            if(t > t1) {
+                return false;
+            }
+            t0 = std::max(t0, t);
+        } else {
+            if(t < t0) {
+                return false;
+            }
+            t1 = std::min(t1, t);
         }
     }
-    if(pt.empty()) {
-        segment edge1(opoints[3], opoints[0]);
-        intersection(edge0, edge1, pt);
+    // clamping removes the rounding error of points lying on the boundary
+    const point_type2 start = pt0;
+    if(t0 > 0) {
+        pt0.x(std::clamp(start.x() + t0 * dx, minX, maxX));
+        pt0.y(std::clamp(start.y() + t0 * dy, minY, maxY));
+    }
+    if(t1 < 1) {
+        pt1.x(std::clamp(start.x() + t1 * dx, minX, maxX));
+        pt1.y(std::clamp(start.y() + t1 * dy, minY, maxY));
     }
-    point_type2 interpts(pt[0].x(), pt[0].y());
-    return interpts;
+    return true;
 }
 
 std::vector<std::pair<polygon_2d, int>> VoronoiDiagram::cutPolygonsWithGeometry(
@@ -501,7 +547,7 @@ std::vector<std::pair<polygon_2d, int>> VoronoiDiagram::cutPolygonsWithCircle(
         }
         correct(circle);
         polygon_list v;
-        intersection(circle, p, v);
+        ConvexClipper(circle).Intersection(p, v);
         // std::cout << "p" << polygon_iterator.second << " = " << dsv(p) << "\n";
         // std::cout << "circle" << polygon_iterator.second << " = " << dsv(circle) << "\n";
 
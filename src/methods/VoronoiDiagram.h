@@ -66,7 +66,16 @@
 class VoronoiDiagram
 {
 private:
+    // buffers of the last frame, the memory is kept for the next frame
     std::vector<point_type2> points;
+    std::vector<double> velocities;
+    std::vector<int> ids;
+    std::vector<int> firstAtSite;
+    std::vector<int> siteOrder;
+    std::vector<std::pair<polygon_2d, int>> cells;
+    boost::polygon::default_voronoi_builder builder;
+    VD diagram;
+
     point_type2 retrieve_point(const cell_type & cell);
     point_type2
     clip_infinite_edge(const edge_type & edge, double minX, double minY, double maxX, double maxY);
@@ -87,14 +96,27 @@ private:
         double minY,
         double maxX,
         double maxY);
-    point_type2
-    getIntersectionPoint(const point_2d & pt0, const point_2d & pt1, const polygon_2d & square);
+    bool clip_segment(
+        point_type2 & pt0,
+        point_type2 & pt1,
+        double minX,
+        double minY,
+        double maxX,
+        double maxY);
 
 public:
     VoronoiDiagram();
     virtual ~VoronoiDiagram();
 
-    std::vector<std::pair<polygon_2d, int>> getVoronoiPolygons(
+    /// removes the data of the last frame, but keeps the allocated memory
+    void clear();
+    /// allocates memory for the given number of pedestrians
+    void reserve(std::size_t numSites);
+    /**
+     * calculates the Voronoi cells of the pedestrians, the returned cells are valid until the
+     * next call
+     */
+    const std::vector<std::pair<polygon_2d, int>> & getVoronoiPolygons(
         std::vector<double> & XInFrame,
         std::vector<double> & YInFrame,
         std::vector<double> & VInFrame,
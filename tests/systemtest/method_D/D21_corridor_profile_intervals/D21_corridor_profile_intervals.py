@@ -0,0 +1,29 @@
+#!/usr/bin/env python3
+# ---------
+# Test functionality of the profiles averaged over intervals of frames
+# ---------
+import os
+from sys import argv, path
+import logging
+
+utestdir = os.path.abspath(os.path.dirname(os.path.dirname(path[0])))
+path.append(utestdir)
+path.append(os.path.dirname(path[0]))  # source helper file
+from tests_method_D import test_profile_intervals
+
+from utils import SUCCESS, FAILURE
+from JPSRunTest import JPSRunTestDriver
+
+# number of frames per interval as given in the ini file
+interval = 25
+
+def runtest(inifile, trajfile):
+    logging.info("===== Method D - Profiles averaged over intervals of frames ===============")
+    test_profile_intervals(trajfile, interval)
+
+
+if __name__ == "__main__":
+    test = JPSRunTestDriver(4, argv0=argv[0], testdir=path[0], utestdir=utestdir, jpsreport=argv[1])
+    test.run_analysis(trajfile="trajectory_grid_6x6.txt", testfunction=runtest)
+    logging.info("%s exits with SUCCESS" % (argv[0]))
+    exit(SUCCESS)
@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+# ---------
+# Test of the profiles in a geometry with an obstacle inside of a Voronoi cell
+# ---------
+import os
+from sys import argv, path
+import logging
+
+utestdir = os.path.abspath(os.path.dirname(os.path.dirname(path[0])))
+path.append(utestdir)
+path.append(os.path.dirname(path[0]))  # source helper file
+from tests_method_D import test_profile_obstacle
+
+from utils import SUCCESS, FAILURE
+from JPSRunTest import JPSRunTestDriver
+
+num_peds = 36
+grid_size = 0.5
+# (row, column) of the grid cells covered by the obstacle, the grid starts at (-0.5, 10.0)
+obstacle_cells = [(10, 58), (10, 59), (11, 58), (11, 59)]
+
+def runtest(inifile, trajfile):
+    logging.info("===== Method D - Profiles with an obstacle ===============")
+    test_profile_obstacle(trajfile, num_peds, grid_size, obstacle_cells)
+
+
+if __name__ == "__main__":
+    test = JPSRunTestDriver(4, argv0=argv[0], testdir=path[0], utestdir=utestdir, jpsreport=argv[1])
+    test.run_analysis(trajfile="trajectory_grid_6x6.txt", testfunction=runtest)
+    logging.info("%s exits with SUCCESS" % (argv[0]))
+    exit(SUCCESS)
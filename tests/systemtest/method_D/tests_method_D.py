@@ -12,6 +12,7 @@ import os
 from sys import argv, path
 import logging
 import math
+import glob
 
 path.append(os.path.dirname(path[0]))  # source helper file
 from utils import SUCCESS, FAILURE
@@ -421,3 +422,85 @@ def test_IFD_density_geometry_intersection_all_frames(trajfile):
             "density values for pedestrians in last row did not match result. Got {}. Expected {} for all values".format(
                 jpsreport_density_last_row, real_density_last_row))
         exit(FAILURE)
+
+
+# ---------
+# Test of the profiles averaged over intervals of frames for Method D
+# The profiles of each frame are output as well (per_frame="true")
+# Mean and population variance of each interval must match those of the profiles of its frames
+# The last interval ends with the last frame of the trajectories
+# Note: the profiles are written with three decimals, the accepted errors cover this rounding
+# ---------
+def test_profile_intervals(trajfile, interval):
+    field_dir = os.path.join('./Output',
+                             'Fundamental_Diagram',
+                             'Classical_Voronoi',
+                             'field')
+
+    # accepted errors of mean and variance due to the rounding of the output
+    acceptance_range_mean = 0.0011
+    acceptance_range_variance = 0.002
+
+    for quantity, prefix in (('density', 'Profile_rho_Voronoi'), ('velocity', 'Profile_v_Voronoi')):
+        var_prefix = prefix.replace('_Voronoi', '_var_Voronoi')
+        frame_files = glob.glob(os.path.join(field_dir, quantity, '%s_%s_?????.dat' % (prefix, trajfile)))
+        window_files = sorted(glob.glob(os.path.join(field_dir, quantity,
+                                                     '%s_%s_?????-?????.dat' % (prefix, trajfile))))
+        if not frame_files or not window_files:
+            logging.critical("jpsreport did not output the %s profiles correctly." % quantity)
+            exit(FAILURE)
+
+        frames = sorted(int(f[-9:-4]) for f in frame_files)
+        for window_file in window_files:
+            first_frame, last_frame = (int(frame) for frame in window_file[-15:-4].split('-'))
+            if last_frame - first_frame + 1 > interval:
+                logging.critical("interval of %s is longer than %d frames." % (window_file, interval))
+                exit(FAILURE)
+
+            window_frames = [frame for frame in frames if first_frame <= frame <= last_frame]
+            profiles = np.array([np.loadtxt(os.path.join(field_dir, quantity, '%s_%s_%05d.dat' %
+                                                         (prefix, trajfile, frame)))
+                                 for frame in window_frames])
+            jpsreport_mean = np.loadtxt(window_file)
+            jpsreport_variance = np.loadtxt(window_file.replace(prefix, var_prefix))
+
+            if not np.all(np.abs(jpsreport_mean - profiles.mean(axis=0)) < acceptance_range_mean):
+                logging.critical("mean of %s does not match the profiles of its frames." % window_file)
+                exit(FAILURE)
+            if not np.all(np.abs(jpsreport_variance - profiles.var(axis=0)) < acceptance_range_variance):
+                logging.critical("variance of %s does not match the profiles of its frames." % window_file)
+                exit(FAILURE)
+
+        if int(window_files[-1][-9:-4]) != frames[-1]:
+            logging.critical("last interval of the %s profiles does not end with the last frame." % quantity)
+            exit(FAILURE)
+        logging.info("%s profiles averaged over intervals should be OK." % quantity)
+
+
+def test_profile_obstacle(trajfile, num_peds, grid_size, obstacle_cells):
+    field_dir = os.path.join('./Output',
+                             'Fundamental_Diagram',
+                             'Classical_Voronoi',
+                             'field')
+
+    # accepted error of the number of pedestrians due to the rounding of the output
+    acceptance_range_peds = 0.2
+
+    density_files = sorted(glob.glob(os.path.join(field_dir, 'density',
+                                                  'Profile_rho_Voronoi_%s_?????.dat' % trajfile)))
+    if not density_files:
+        logging.critical("jpsreport did not output the density profiles correctly.")
+        exit(FAILURE)
+
+    for density_file in density_files:
+        density = np.loadtxt(density_file)
+        velocity = np.loadtxt(density_file.replace('density', 'velocity').replace('Profile_rho', 'Profile_v'))
+        for row, column in obstacle_cells:
+            if density[row, column] != 0 or velocity[row, column] != 0:
+                logging.critical("%s is not zero inside of the obstacle." % density_file)
+                exit(FAILURE)
+        # the Voronoi cells without the obstacle cover the geometry, each one counts once
+        if abs(density.sum() * grid_size ** 2 - num_peds) > acceptance_range_peds:
+            logging.critical("density of %s does not add up to %d pedestrians." % (density_file, num_peds))
+            exit(FAILURE)
+    logging.info("profiles with an obstacle should be OK.")